@@ -0,0 +1,336 @@
+/*
+ * Display MCU of the split build (see header/link.h, "make split")
+ *
+ * Owns both Nokia displays. Display commands arrive from the control MCU
+ * over the SPI (slave) and are rendered here, so the control MCU never
+ * draws or waits on an LCD bus. The Nokia bus itself runs on USART1 in
+ * master SPI mode (nokia5110.c built with -DNOKIA_USART).
+ *
+ * Wiring: PB4 SS, PB5 MOSI, PB7 SCK from the control MCU; Nokia SCE PB1
+ * (fan animation), SCE2 PB0 (status), RST PB2, DC PB3, DIN PD3 (TXD1),
+ * CLK PD4 (XCK1).
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+#include "timer.h"
+#include "nokia5110.h"
+#include "fanframes.h"
+#include "uart.h"
+#include "link.h"
+
+#ifdef _SIMULATE_
+#include "/usr/local/include/simavr/avr/avr_mcu_section.h"
+AVR_MCU(F_CPU, "atmega1284");
+#endif
+
+#define LINK_RX_FRAMES 4 // power of two
+
+typedef struct {
+    unsigned char type;
+    unsigned char len;
+    unsigned char payload[LINK_MAX];
+} link_frame_t;
+
+static link_frame_t rxFrames[LINK_RX_FRAMES];
+static volatile unsigned char rxHead = 0; // written by the SPI ISR
+static volatile unsigned char rxTail = 0; // written by link_recvFrame()
+
+volatile unsigned char linkRxErrors = 0;  // bad CRC or oversized
+volatile unsigned char linkRxDropped = 0; // good frames that found the ring full
+
+// RX parser state (ISR only), as in uart.c
+enum link_rxStates {rx_sync1, rx_sync2, rx_len, rx_type, rx_payload, rx_crc};
+static unsigned char rxState = rx_sync1;
+static unsigned char rxPos = 0;
+static unsigned char rxCrc = 0;
+static unsigned char rxLen = 0;
+static unsigned char rxType = 0;
+static unsigned char rxKeep = 0;
+
+#define link_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+void link_rxInit(void) {
+    // slave: SS, MOSI and SCK are inputs, MISO is left undriven
+    SPCR = (1 << SPIE) | (1 << SPE);
+}
+
+// Must finish within a byte time of the link (128 cycles at fosc/16)
+ISR(SPI_STC_vect) {
+    unsigned char c = SPDR;
+    link_frame_t *f = &rxFrames[rxHead & (LINK_RX_FRAMES - 1)];
+
+    switch(rxState) {
+        case rx_sync1:
+            if(c == UART_SYNC1)
+                rxState = rx_sync2;
+            break;
+        case rx_sync2:
+            if(c == UART_SYNC2)
+                rxState = rx_len;
+            else if(c != UART_SYNC1)
+                rxState = rx_sync1;
+            break;
+        case rx_len:
+            if(c > LINK_MAX) {
+                linkRxErrors++;
+                rxState = rx_sync1;
+                break;
+            }
+            rxLen = c;
+            rxCrc = _crc8_ccitt_update(0x00, c);
+            rxState = rx_type;
+            break;
+        case rx_type:
+            rxType = c;
+            rxCrc = _crc8_ccitt_update(rxCrc, c);
+            rxPos = 0;
+            rxKeep = (unsigned char)(rxHead - rxTail) < LINK_RX_FRAMES;
+            rxState = rxLen ? rx_payload : rx_crc;
+            break;
+        case rx_payload:
+            if(rxKeep)
+                f->payload[rxPos] = c;
+            rxCrc = _crc8_ccitt_update(rxCrc, c);
+            if(++rxPos == rxLen)
+                rxState = rx_crc;
+            break;
+        case rx_crc:
+            rxState = rx_sync1;
+            if(c != rxCrc) {
+                linkRxErrors++;
+                break;
+            }
+            if(!rxKeep) {
+                linkRxDropped++;
+                break;
+            }
+            f->type = rxType;
+            f->len = rxLen;
+            link_barrier();
+            rxHead++;
+            break;
+        default:
+            rxState = rx_sync1;
+            break;
+    }
+}
+
+unsigned char link_recvFrame(link_frame_t *f) {
+    unsigned char tail = rxTail;
+    if(tail == rxHead)
+        return 0;
+    *f = rxFrames[tail & (LINK_RX_FRAMES - 1)];
+    link_barrier();
+    rxTail = tail + 1;
+    return 1;
+}
+
+// What the control MCU asked for
+unsigned char fields[LINK_FIELDS];
+char textLines[6][LINK_TEXT_MAX + 1];
+unsigned char statusDirty = 1;
+unsigned char frameWanted = 0;
+unsigned char powerWanted = 1;
+
+nokia_lcd_t lcdFan;    // fan animation display
+nokia_lcd_t lcdStatus; // status display
+
+// Apply every frame received since the last tick
+void R_Tick() {
+    link_frame_t f;
+    unsigned char i;
+
+    while(link_recvFrame(&f)) {
+        switch(f.type) {
+            case LINK_STATUS:
+                for(i = 0; i + 1 < f.len; i += 2)
+                    if(f.payload[i] < LINK_FIELDS && fields[f.payload[i]] != f.payload[i + 1]) {
+                        fields[f.payload[i]] = f.payload[i + 1];
+                        statusDirty = 1;
+                    }
+                break;
+            case LINK_FRAME:
+                if(f.len == 1 && f.payload[0] < FAN_FRAME_COUNT)
+                    frameWanted = f.payload[0];
+                break;
+            case LINK_TEXT:
+                if(f.len < 1 || f.payload[0] >= 6)
+                    break;
+                for(i = 0; i + 1 < f.len && i < LINK_TEXT_MAX; i++)
+                    textLines[f.payload[0]][i] = f.payload[i + 1];
+                textLines[f.payload[0]][i] = '\0';
+                statusDirty = 1;
+                break;
+            case LINK_POWER:
+                if(f.len == 1)
+                    powerWanted = f.payload[0] ? 1 : 0;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Panel bring-up, as b2_Tick in main.c
+enum boot_States{b_start, b_reset, b_panels, b_done} b_state;
+void b_Tick() {
+    switch(b_state) { // transitions
+        case b_start:
+            b_state = b_reset;
+            break;
+        case b_reset:
+            if(nokia_bus_init_Tick())
+                b_state = b_panels;
+            break;
+        case b_panels:
+            b_state = b_done;
+            break;
+        case b_done:
+            break;
+        default:
+            b_state = b_start;
+            break;
+    }
+    switch(b_state) { // state actions
+        case b_panels:
+            nokia_lcd_init(&lcdFan, LCD_SCE, 2);
+            nokia_lcd_init(&lcdStatus, LCD_SCE2, 1);
+            break;
+        default:
+            break;
+    }
+}
+
+// Status display: the same layout main.c draws in the single MCU build,
+// plus any LINK_TEXT lines in the fixed font
+enum display1_States{d1_start, d1_update} d1_state;
+void d1_Tick() {
+    unsigned char line;
+
+    switch(d1_state) { // transitions
+        case d1_start:
+            d1_state = d1_update;
+            break;
+        case d1_update:
+            d1_state = d1_update;
+            break;
+        default:
+            d1_state = d1_start;
+            break;
+    }
+    switch(d1_state) { // state actions
+        case d1_start:
+            break;
+        case d1_update:
+            if(!statusDirty)
+                break;
+            nokia_lcd_clear(&lcdStatus);
+            nokia_lcd_set_font(&lcdStatus, NOKIA_FONT_PROP);
+            nokia_lcd_write_string_P(&lcdStatus, PSTR("Pwr: "), 1);
+            nokia_lcd_write_string_P(&lcdStatus, fields[LINK_FIELD_POWER] ? PSTR("On") : PSTR("Off"), 1);
+            nokia_lcd_set_cursor(&lcdStatus, 0, 8);
+            nokia_lcd_write_string_P(&lcdStatus, PSTR("Osc: "), 1);
+            nokia_lcd_write_string_P(&lcdStatus, fields[LINK_FIELD_OSC] ? PSTR("On") : PSTR("Off"), 1);
+            nokia_lcd_set_cursor(&lcdStatus, 0, 16);
+            nokia_lcd_write_string_P(&lcdStatus, PSTR("Spd: "), 1);
+            if(fields[LINK_FIELD_TEMP])
+                nokia_lcd_write_string_P(&lcdStatus, PSTR("Temp"), 1);
+            else
+                nokia_lcd_write_char(&lcdStatus, fields[LINK_FIELD_SPEED] + '0', 1);
+            nokia_lcd_set_font(&lcdStatus, NOKIA_FONT_FIXED);
+            for(line = 0; line < 6; line++) {
+                if(textLines[line][0] == '\0')
+                    continue;
+                nokia_lcd_set_cursor(&lcdStatus, 0, line * 8);
+                nokia_lcd_write_string(&lcdStatus, textLines[line], 1);
+            }
+            nokia_lcd_flush(&lcdStatus);
+            statusDirty = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+// Fan animation: draw whichever frame the control MCU last sent
+unsigned char frameShown = 0xFF;
+void d2_Tick() {
+    if(frameWanted == frameShown)
+        return;
+    nokia_lcd_clear(&lcdFan);
+    nokia_lcd_set_cursor(&lcdFan, 18, 0);
+    nokia_lcd_write_bitmap_P(&lcdFan, fanFrames[frameWanted], FAN_FRAME_WIDTH, FAN_FRAME_BANKS);
+    nokia_lcd_flush(&lcdFan);
+    frameShown = frameWanted;
+}
+
+unsigned char powerShown = 1;
+void P_Tick() {
+    if(powerWanted == powerShown)
+        return;
+    nokia_lcd_power(&lcdFan, powerWanted);
+    nokia_lcd_power(&lcdStatus, powerWanted);
+    powerShown = powerWanted;
+}
+
+// No foreground tier: everything here waits on the link, not the tick
+void fg_Tick(void) {
+}
+
+int main(void) {
+    DDRB = 0x0F; PORTB = 0x03; // Output: Nokia SCE/SCE2 (deselected), RST, DC. Input: link SS, MOSI, SCK
+    DDRD = 0x18; PORTD = 0x00; // Output: Nokia DIN (TXD1), CLK (XCK1)
+
+    unsigned long R_elapsedTime = 0;
+    unsigned long boot_elapsedTime = 0;
+    unsigned long d1_elapsedTime = 0;
+    unsigned long d2_elapsedTime = 0;
+    unsigned long bus_elapsedTime = 0;
+    const unsigned long timerPeriod = 1;
+
+    b_state = b_start;
+    d1_state = d1_start;
+
+    link_rxInit();
+    TimerSet(timerPeriod);
+    TimerOn();
+
+    while (1) {
+        if(R_elapsedTime >= 1) {
+            R_Tick();
+            R_elapsedTime = 0;
+        }
+        if(boot_elapsedTime >= 1 && b_state != b_done) {
+            b_Tick();
+            boot_elapsedTime = 0;
+        }
+        if(b_state == b_done) {
+            if(d1_elapsedTime >= 10) {
+                d1_Tick();
+                d1_elapsedTime = 0;
+            }
+            if(d2_elapsedTime >= 1) {
+                d2_Tick();
+                P_Tick();
+                d2_elapsedTime = 0;
+            }
+            if(bus_elapsedTime >= 1) {
+                nokia_bus_Tick();
+                bus_elapsedTime = 0;
+            }
+        }
+
+        while(!TimerFlag) {}
+        TimerFlag = 0;
+
+        R_elapsedTime += timerPeriod;
+        boot_elapsedTime += timerPeriod;
+        d1_elapsedTime += timerPeriod;
+        d2_elapsedTime += timerPeriod;
+        bus_elapsedTime += timerPeriod;
+    }
+    return 0;
+}
@@ -1,13 +1,68 @@
 #ifndef __ADC_H__
 #define __ADC_H__
 
+#include <avr/interrupt.h>
+#include "input.h"
+#include "zone.h"
+
+#define TEMP_CHANNEL 7 // thermistor divider on PA7 (ADC7), zone z on ZONE_CHANNEL(z)
+#define TEMP_CHANNELS ((0xFF00 >> ZONES) & 0xFF) // ADC7 down to ADC(8 - ZONES)
+
+#ifdef REPLAY
+#include "replay.h"
+#define ADC_sample() replayAdc // conversions return the recorded sample
+#else
+#define ADC_sample() ((unsigned char)(ADC >> 2))
+#endif
+
+volatile unsigned char adcSamples[ZONES]; // last sample of each zone
+static volatile unsigned char adcZone = 0; // zone being converted
+
 void ADC_init() {
-    ADCSRA |= (1 << ADEN) | (1 << ADSC) | (1 << ADATE);
+    ADMUX = (1 << REFS0) | TEMP_CHANNEL;
+    ADCSRA = (1 << ADEN) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1);
+    DIDR0 = TEMP_CHANNELS;
+    // REFS0: AVCC as the reference.
     // ADEN : setting this bit enables analog-to-digital conversion.
-    // ADSC : setting this bit starts the first conversion.
-    // ADATE: setting this this bit enables auto-triggering. Since we are
-    //          in Free Running mode, a new conversion will trigger whenever
-    //          the previous conversion completes.
+    // ADIE : conversion complete interrupt, stores the sample and posts
+    //          EV_TEMP to inputQueue.
+    // ADPS : 8 MHz / 64 = 125 kHz ADC clock.
+    // Single conversions only (no ADATE free running), so the ADC is idle
+    //          between temperature checks and can be switched off for standby.
+}
+
+// Start a scan of every zone's thermistor, zone 0 first. Each result
+// arrives as an EV_TEMP event for its zone, the sample in adcSamples[].
+void ADC_start() {
+    adcZone = 0;
+    ADMUX = (1 << REFS0) | ZONE_CHANNEL(0);
+    ADCSRA |= (1 << ADEN) | (1 << ADIE) | (1 << ADSC);
+}
+
+// Round robin: the next channel is selected and started from here, so a
+// scan costs the main loop nothing past ADC_start
+ISR(ADC_vect) {
+    unsigned char z = adcZone;
+
+    adcSamples[z] = ADC_sample();
+    evq_push(&inputQueue, EV_TEMP, z);
+    if(++z < ZONES) {
+        adcZone = z;
+        ADMUX = (1 << REFS0) | ZONE_CHANNEL(z);
+        ADCSRA |= (1 << ADSC);
+    }
+}
+
+// One blocking conversion of zone z's thermistor (~104 us). Returns the
+// top 8 bits of the result, which are the units of a zone's temp and
+// threshold. (used from standby, where no task is running to take the event)
+unsigned char ADC_readTemp(unsigned char z) {
+    ADCSRA &= ~(1 << ADIE);
+    ADMUX = (1 << REFS0) | ZONE_CHANNEL(z);
+    ADCSRA |= (1 << ADEN) | (1 << ADSC);
+    while(ADCSRA & (1 << ADSC)) {}
+    ADCSRA |= (1 << ADIF) | (1 << ADIE); // clear the flag so the ISR doesn't fire
+    return ADC_sample();
 }
 
-#endif
\ No newline at end of file
+#endif
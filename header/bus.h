@@ -0,0 +1,153 @@
+#ifndef __BUS_H__
+#define __BUS_H__
+
+#include "uart.h"
+#include "zone.h"
+
+/*
+ * Fan bus: many controllers on one RS-485 pair (make NODE=<id>)
+ *
+ * On a bus node USART0 drives a half-duplex RS-485 transceiver instead of
+ * the host link: TXD0 to DI, RXD0 to RO, PA6 to DE and /RE together, so
+ * the driver is on only while a frame goes out and a node never hears
+ * itself. The oscillation LED gives PA6 up.
+ *
+ * Node 0 is the master (make NODE=0 NODES=<n>, itself included) and the
+ * only one that talks unprompted. Nodes 1 .. BUS_NODES - 1 answer a frame
+ * addressed to them with exactly one BUS_STATUS and never answer a
+ * broadcast, so no two drivers are ever on at once: the master sends its
+ * next frame only once the answer is in or BUS_REPLY_MS went by.
+ *
+ * Frames are uart.h's; every payload starts with destination and source:
+ *
+ *     BUS_POLL    dst src seq                      master -> node
+ *     BUS_CMD     dst src seq op arg [op arg ...]  master -> node or BUS_BROADCAST
+ *     BUS_STATUS  bus_status_t                     node -> master
+ *
+ * BUS_CMD ops are command.h's, run as one batch like a CMD_FRAME; the
+ * BUS_STATUS that answers it carries the ack. Ops that would send frames
+ * of their own (telemetry, a history dump) are refused on the bus.
+ *
+ * The master polls the nodes in turn and keeps them on the group state its
+ * own fan sets (busGroup):
+ *  - power: a node that isn't in temperature mode and reports the wrong
+ *    power gets a BUS_CMD in place of its poll. Nodes are switched on
+ *    BUS_STAGGER_MS apart, after the master, to spread the motors'
+ *    inrush; they are switched off at once.
+ *  - speed preset and temperature: broadcast on a preset change and every
+ *    BUS_SYNC_MS. A node in temperature mode goes by the master's reading
+ *    (CMD_TEMP) with its own threshold.
+ * A node that misses BUS_REPLY_MS is polled again on the next round.
+ *
+ * Nodes stay awake: USART0 is gated in standby and would miss the polls.
+ * tools/fanbus.py is the bus between simulated nodes (make busbench) and
+ * decodes it -- keep the two in sync.
+ */
+
+#ifdef BUS_NODE
+
+#define BUS_NODES_MAX 16
+
+#ifndef BUS_NODES
+#define BUS_NODES 4
+#endif
+
+#if BUS_NODE < 0 || BUS_NODE >= BUS_NODES_MAX
+#error "BUS_NODE must be 0 (master) to BUS_NODES_MAX - 1"
+#endif
+#if BUS_NODES < 2 || BUS_NODES > BUS_NODES_MAX
+#error "BUS_NODES must be 2 to BUS_NODES_MAX"
+#endif
+#if ZONES > 1
+#error "bus nodes run one fan each (PA6 is DE), build them without ZONES"
+#endif
+
+#define BUS_DE_PIN PORTA, 6 // transceiver DE and /RE, high while sending
+
+#define BUS_MASTER    0x00
+#define BUS_BROADCAST 0xFF
+
+// Frame types
+#define BUS_POLL   0x30
+#define BUS_CMD    0x31
+#define BUS_STATUS 0x32
+
+#define BUS_HEADER 3 // dst, src, seq
+
+#define BUS_REPLY_MS   20   // an answer is due this long after the frame was queued
+#define BUS_STAGGER_MS 500  // between two motor starts
+#define BUS_SYNC_MS    1000 // group broadcast period
+
+typedef struct {
+    unsigned char dst;
+    unsigned char src;
+    unsigned char seq;      // of the frame answered
+    unsigned char status;   // CMD_* of a BUS_CMD, CMD_OK for a poll
+    unsigned char ops;      // ops of the BUS_CMD done
+    unsigned char on;
+    unsigned char speed;    // preset
+    unsigned char tempMode;
+    unsigned char temp;     // reading in use, ADC units
+    unsigned short rpm;
+} bus_status_t;
+
+// A BUS_POLL or BUS_CMD for this node or everyone
+typedef struct {
+    unsigned char seq;
+    unsigned char reply; // addressed to this node: answer with bus_reply()
+    unsigned char len;   // bytes of op/arg pairs
+    unsigned char ops[UART_RX_MAX - BUS_HEADER];
+} bus_request_t;
+
+/*
+ * Transceiver off the bus; call before uart_init()
+ */
+void bus_init(void);
+
+#if BUS_NODE == BUS_MASTER
+
+// Group state the master's fan sets, kept up to date by main.c
+typedef struct {
+    unsigned char on;
+    unsigned char speed;
+    unsigned char temp;
+} bus_group_t;
+
+// The master's view of a node, from its last BUS_STATUS
+typedef struct {
+    unsigned char alive;    // answered its last frame
+    unsigned char on;
+    unsigned char speed;
+    unsigned char tempMode;
+    unsigned char temp;
+    unsigned short rpm;
+    unsigned char timeouts; // saturating
+} bus_node_t;
+
+extern bus_group_t busGroup;
+extern bus_node_t busNodes[BUS_NODES]; // by node ID, 0 unused
+
+/*
+ * Master, every 1 ms: collect the answer, send the next frame when the
+ * bus is free
+ */
+void bus_Tick(void);
+
+#else
+
+/*
+ * Node: take the next frame for this node or everyone. Returns 0 when
+ * there is none.
+ */
+unsigned char bus_recv(bus_request_t *r);
+
+/*
+ * Node: answer the frame just taken (dst and src are filled in)
+ */
+void bus_reply(bus_status_t *s);
+
+#endif
+
+#endif
+
+#endif
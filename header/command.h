@@ -0,0 +1,52 @@
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+/*
+ * Command protocol on USART0 (frames as in uart.h)
+ *
+ * CMD_FRAME payload: seq, then one or more op/arg pairs. The ops of a frame
+ * are run in order in one C_Tick, so a batch takes effect together; the
+ * first op that fails stops the batch. Every command frame is answered with
+ * a CMD_ACK frame:
+ *
+ *     seq (echoed), status (CMD_OK or the error of the failed op),
+ *     ops done (how many ops ran)
+ *
+ * A CMD_QUERY op sends a telemetry frame (telemetry.h) right after the ack.
+ * Frames lost to a bad CRC are not acked; the sender retries on timeout.
+ * USART0 is gated in standby, so frames sent then are lost; a frame being
+ * received counts as activity and holds off standby.
+ * On a bus node the ops arrive in BUS_CMD frames instead (bus.h).
+ * tools/fanctl.py speaks this protocol -- keep the two in sync.
+ */
+
+#define CMD_FRAME 0x10
+#define CMD_ACK   0x11
+
+// Ops, each followed by one argument byte
+#define CMD_POWER     0x01 // 0 off, 1 on
+#define CMD_SPEED     0x02 // preset, 0 .. maxSpeed - 1
+#define CMD_DUTY      0x03 // fixed motor duty in percent (0 .. 100), replaces the preset and speed hold
+#define CMD_HOLD      0x04 // 0 open loop, 1 hold the preset's rpm (tach)
+#define CMD_SERVO     0x05 // hold the servo at 0 .. 180 degrees (stops oscillation), 0xFF releases it
+#define CMD_OSC       0x06 // 0 off, 1 oscillate
+#define CMD_TEMPMODE  0x07 // 0 off, 1 temperature mode
+#define CMD_THRESHOLD 0x08 // temperature threshold, same units as a zone's temp
+#define CMD_TELEMETRY 0x09 // telemetry period in 10 ms steps, 0 stops it
+#define CMD_QUERY     0x0A // arg 0: send a telemetry frame after the ack
+#define CMD_HISTORY   0x0B // history log (history.h): 0 dump it, 1 clear it, 2 checkpoint it to EEPROM
+#define CMD_HISTRATE  0x0C // history sample period in seconds, 0 stops sampling
+#define CMD_ZONE      0x0D // zone (zone.h) the rest of the frame's POWER, SPEED, TEMPMODE,
+                           // THRESHOLD and TEMP ops work, 0 .. ZONES - 1; each frame starts on zone 0.
+                           // DUTY and HOLD are zone 0's only.
+#define CMD_TEMP      0x0E // temperature reading from elsewhere (the bus master's, bus.h), same
+                           // units as temp; stands in for the zone's own sensor while they keep
+                           // coming, TEMP_SHARED_MS at most
+
+// Ack status
+#define CMD_OK        0x00
+#define CMD_BAD_OP    0x01
+#define CMD_BAD_ARG   0x02
+#define CMD_BAD_FRAME 0x03 // no seq, or an op without its argument
+
+#endif
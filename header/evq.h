@@ -0,0 +1,68 @@
+#ifndef __EVQ_H__
+#define __EVQ_H__
+
+/*
+ * Single-producer / single-consumer event queue
+ *
+ * The producer side is interrupt context. AVR ISRs don't nest, so every ISR
+ * posting to the same queue counts as one producer. The consumer is a task
+ * in the main loop. head is only written by the producer and tail only by
+ * the consumer; both are 8-bit, so each update is a single store and neither
+ * side needs to disable interrupts.
+ *
+ * head and tail run freely and are masked on access, which is why
+ * EVQ_SIZE must be a power of two (and at most 128).
+ */
+
+#define EVQ_SIZE 16
+
+#define evq_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+// Event types
+#define EV_NONE 0
+#define EV_KEY  1 // arg: button mask as on ~PINA (0x08 power, 0x04 speed, 0x02 osc, 0x01 temp)
+#define EV_IR   2 // arg: index into keyValue[] (IR.h)
+#define EV_TEMP 3 // arg: zone (zone.h) with a new sample in adcSamples[] (ADC.h)
+
+typedef struct {
+    unsigned char type;
+    unsigned char arg;
+} event_t;
+
+typedef struct {
+    event_t buf[EVQ_SIZE];
+    volatile unsigned char head;    // next slot to fill (producer)
+    volatile unsigned char tail;    // next slot to read (consumer)
+    volatile unsigned char dropped; // events lost because the queue was full
+} evq_t;
+
+// Producer: returns 0 and counts a drop when the queue is full
+static inline unsigned char evq_push(evq_t *q, unsigned char type, unsigned char arg) {
+    unsigned char head = q->head;
+    if((unsigned char)(head - q->tail) >= EVQ_SIZE) {
+        q->dropped++;
+        return 0;
+    }
+    q->buf[head & (EVQ_SIZE - 1)].type = type;
+    q->buf[head & (EVQ_SIZE - 1)].arg = arg;
+    evq_barrier(); // slot contents before the new head
+    q->head = head + 1;
+    return 1;
+}
+
+// Consumer: returns 0 when the queue is empty
+static inline unsigned char evq_pop(evq_t *q, event_t *e) {
+    unsigned char tail = q->tail;
+    if(tail == q->head)
+        return 0;
+    *e = q->buf[tail & (EVQ_SIZE - 1)];
+    evq_barrier(); // slot read before it is handed back
+    q->tail = tail + 1;
+    return 1;
+}
+
+static inline unsigned char evq_empty(const evq_t *q) {
+    return q->tail == q->head;
+}
+
+#endif
@@ -0,0 +1,175 @@
+// Fan rotation frames generated from fan02 (fanbitmaps.h)
+// File generated by tools/fanframes.py --frames 8 --sweep 90, do not edit
+#ifndef __FANFRAMES_H__
+#define __FANFRAMES_H__
+
+#include <avr/pgmspace.h>
+
+#define FAN_FRAME_COUNT 8
+#define FAN_FRAME_WIDTH 48
+#define FAN_FRAME_BANKS 6
+
+const uint8_t fanFrames[FAN_FRAME_COUNT][FAN_FRAME_WIDTH * FAN_FRAME_BANKS] PROGMEM = {
+	{ // 0 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xA0, 0xF0, 0xF0, 0xF8, 0xF0, 0xFC, 0xFC,
+	0xDC, 0xAC, 0xF4, 0xBC, 0xFC, 0x78, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80,
+	0x80, 0xC0, 0xC0, 0xC0, 0x80, 0xC0, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6C, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xED, 0x7B, 0xAF, 0xFF, 0x0D, 0x03, 0x00, 0x00, 0x00, 0x80, 0xF0, 0xEC, 0xF4, 0xAD, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xBF, 0xF5, 0xFA, 0x7C, 0xF8, 0xC0, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x05, 0x0B, 0x0F, 0x1F, 0x1F, 0x2F, 0x37,
+	0x3F, 0x3F, 0x77, 0x6F, 0x77, 0x5E, 0x38, 0x10, 0x10, 0x18, 0x3B, 0xF5, 0x5B, 0x27, 0x2F, 0x1F,
+	0x1D, 0x1E, 0x1D, 0x35, 0x3A, 0x3D, 0x5B, 0x7F, 0x7E, 0x5F, 0x3E, 0x7F, 0x3B, 0x1F, 0x00, 0x00,
+	0x00, 0x00, 0x60, 0xF4, 0xFC, 0xBE, 0xFE, 0xBC, 0x7A, 0xF4, 0xFC, 0x7C, 0xEC, 0x78, 0xD8, 0xB8,
+	0xF0, 0xEC, 0xB4, 0xEC, 0xF7, 0xF8, 0x2C, 0x10, 0x08, 0x08, 0x4C, 0xF3, 0xDC, 0xFC, 0xFC, 0xEC,
+	0xFC, 0xF8, 0xB8, 0xF0, 0xF0, 0xF0, 0xA0, 0x40, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x03, 0x1F, 0x3B, 0x3F, 0xEF, 0xF7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xEF, 0x7F, 0x3F, 0x0F, 0x05, 0x00, 0x00, 0x00, 0xC0, 0xF0, 0xF5, 0xEB, 0xBD, 0x7B, 0xDD,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFD, 0x5C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02, 0x01, 0x03, 0x03, 0x01, 0x02, 0x01,
+	0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x0F, 0x3D, 0x17, 0x3F, 0x3D, 0x3E,
+	0x3F, 0x25, 0x1F, 0x0D, 0x0F, 0x0B, 0x07, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 11.25 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0xE0, 0xF8, 0xE8, 0xFC, 0xFC,
+	0xFE, 0xFC, 0xFF, 0xFE, 0xEE, 0xD6, 0xFA, 0xFE, 0x7C, 0xB8, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x3D, 0xFF, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xF7, 0xBE, 0xD5, 0xFF, 0x0F, 0x05, 0x03, 0x00, 0x00, 0x00, 0xE0, 0xD0, 0xE8,
+	0x58, 0xF4, 0xFE, 0xFE, 0xFF, 0xFF, 0xFE, 0xFC, 0xFE, 0xFC, 0xFC, 0x58, 0xB0, 0xC0, 0x80, 0x00,
+	0x00, 0x00, 0x00, 0x40, 0xC0, 0xE0, 0xC0, 0x80, 0x40, 0x80, 0x80, 0x01, 0x03, 0x07, 0x07, 0x0B,
+	0x0D, 0x1F, 0x3F, 0x3B, 0xB7, 0x3B, 0x3E, 0x18, 0x10, 0x10, 0x18, 0xF6, 0xAB, 0x77, 0x4F, 0x1F,
+	0x7E, 0x77, 0x7B, 0xF7, 0xD7, 0xD7, 0xEF, 0xDF, 0xFF, 0xF7, 0xFD, 0xEF, 0xF7, 0xBF, 0xFF, 0x04,
+	0x20, 0xF6, 0xBF, 0xFF, 0xFB, 0xFF, 0xF7, 0xEF, 0xFF, 0xFE, 0xEF, 0xFB, 0xDF, 0xF6, 0xEE, 0xFE,
+	0xF4, 0xDA, 0xF6, 0xFA, 0x7F, 0x2C, 0x10, 0x08, 0x08, 0x48, 0xE0, 0xBF, 0xF8, 0xF8, 0xD8, 0xF0,
+	0xE0, 0xE0, 0xC0, 0xC0, 0x80, 0x01, 0x02, 0x03, 0x03, 0x02, 0x03, 0x07, 0x03, 0x01, 0x00, 0x00,
+	0x00, 0x01, 0x03, 0x0B, 0x1E, 0x3E, 0x5F, 0x3F, 0x7F, 0x7F, 0x7F, 0xBF, 0x7F, 0x7F, 0x3F, 0x37,
+	0x1F, 0x0F, 0x07, 0x02, 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xCD, 0x77, 0xFB, 0xB7, 0xFB, 0xFF, 0xFF,
+	0xFF, 0xFE, 0xFF, 0xFF, 0xFD, 0xFB, 0xEC, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x0F, 0x3F, 0x35, 0x7F, 0x7B, 0x7E, 0x7D, 0x8B, 0x7F, 0x37,
+	0x3F, 0x2F, 0x1F, 0x1F, 0x0F, 0x07, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 22.5 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xA0, 0xF0, 0xF8, 0xF8,
+	0xFE, 0xFA, 0xFE, 0xFF, 0xFE, 0xFF, 0xFE, 0xFF, 0xCF, 0xF6, 0xBA, 0xFC, 0x7C, 0x54, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x3F, 0x4F, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xBB, 0xDE, 0x75, 0x1F, 0x0F, 0x01, 0x07, 0x00, 0x00, 0xC0,
+	0x40, 0xA0, 0x60, 0xD0, 0xF0, 0xF8, 0xF0, 0xF8, 0xF8, 0xF0, 0xE0, 0xE0, 0xC0, 0x80, 0x00, 0x00,
+	0x80, 0xA0, 0xE0, 0xF0, 0xBC, 0xF8, 0x7C, 0xFC, 0xE0, 0xD8, 0xE0, 0x60, 0xE0, 0x80, 0x81, 0x01,
+	0x05, 0x86, 0x0F, 0x1F, 0x9D, 0x37, 0x2B, 0x3F, 0x1A, 0x10, 0x20, 0xF0, 0xD4, 0x76, 0x8F, 0x7F,
+	0xFF, 0xFD, 0xDF, 0xEF, 0xBF, 0x3F, 0x5F, 0xFF, 0xFF, 0xFF, 0x5F, 0xFF, 0xF7, 0x7D, 0xFB, 0xB8,
+	0x1D, 0xBB, 0xFF, 0xEF, 0xEF, 0xFF, 0xFE, 0xFF, 0xFF, 0xFB, 0xFF, 0xFB, 0xFF, 0xF9, 0xFF, 0xFE,
+	0xF5, 0xFD, 0x7B, 0x3D, 0x15, 0x0E, 0x00, 0x48, 0x98, 0xE8, 0xB4, 0xF3, 0xF1, 0x70, 0xE1, 0xC0,
+	0x80, 0x01, 0x01, 0x07, 0x06, 0x17, 0x17, 0x1E, 0x3F, 0x0F, 0x7F, 0x3E, 0x1F, 0x3B, 0x07, 0x01,
+	0x00, 0x00, 0x01, 0x07, 0x01, 0x0F, 0x0F, 0x0F, 0x17, 0x0F, 0x1F, 0x0F, 0x0F, 0x0D, 0x07, 0x03,
+	0x03, 0x01, 0x00, 0xE0, 0xC0, 0xF0, 0xF0, 0x5A, 0xF7, 0x6B, 0xFF, 0xF7, 0xFF, 0xFF, 0xFF, 0xFB,
+	0xFF, 0xFF, 0xF6, 0x6C, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x23, 0x1F, 0x15, 0x7F, 0x7F, 0xFB, 0xBA, 0x1F, 0x77, 0x6F, 0xFF, 0x3F, 0x7F, 0x7F,
+	0x3F, 0x1F, 0x17, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 33.75 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xE0,
+	0xF8, 0xF8, 0xFC, 0xFC, 0xFF, 0xFC, 0xFF, 0xFF, 0xFF, 0xFF, 0xFC, 0xEE, 0xCE, 0xEE, 0xF4, 0xF8,
+	0xF8, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x80, 0xC0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B, 0x3B,
+	0x7F, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xDF, 0x74, 0x1F, 0x1F, 0x0B, 0x0B, 0x07,
+	0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0xC0, 0xC0, 0x80, 0xC0, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00,
+	0xE0, 0xF8, 0xFE, 0xFF, 0xFF, 0xFF, 0xCF, 0xDF, 0xFF, 0x7C, 0xFF, 0xDC, 0x78, 0x68, 0xE0, 0x80,
+	0x80, 0x41, 0x83, 0x87, 0xCF, 0x1D, 0x3B, 0x0B, 0x1F, 0x1A, 0x20, 0xE0, 0xE0, 0xA8, 0x4C, 0x7C,
+	0xFE, 0xFF, 0x77, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0x7C, 0xD8, 0xD0,
+	0x09, 0x1F, 0x5E, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xBE, 0xFF, 0xFE, 0xFF, 0xFB,
+	0xBF, 0x3D, 0x1F, 0x0F, 0x0A, 0x0A, 0x48, 0xC8, 0x38, 0xE0, 0xF4, 0x63, 0xE2, 0xC0, 0x02, 0x00,
+	0x03, 0x07, 0x17, 0x1F, 0x7A, 0x9B, 0xF6, 0x77, 0x7F, 0xFF, 0xFD, 0xE7, 0xBF, 0x7F, 0x3F, 0x07,
+	0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x01, 0x03, 0x03, 0x01, 0x03, 0x01, 0x01, 0x00, 0x80,
+	0xE0, 0xF0, 0xF0, 0xF8, 0x20, 0xF4, 0x7F, 0xE3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF7, 0xFF, 0xFC,
+	0x9C, 0xD0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x0F,
+	0x1B, 0x3E, 0x7F, 0x7B, 0x1E, 0xDF, 0x77, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0x7F, 0x3F, 0x3F, 0x1F,
+	0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 45 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0xC0, 0xF0, 0xF0, 0xFC, 0xFC, 0xFE, 0xFE, 0xFE, 0xFF, 0xFD, 0xFE, 0xFF, 0xFE, 0xFE, 0xDC,
+	0xFE, 0xDC, 0xD8, 0xF0, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x80, 0xC0, 0x80, 0xF0, 0xE0, 0x70, 0xF8, 0xF8, 0xF0, 0xF0, 0x80, 0x80, 0x00, 0x00, 0x00,
+	0x00, 0x0B, 0xB9, 0xBF, 0xFF, 0xBF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x97, 0x6F, 0x39, 0x3F, 0x3F,
+	0x07, 0x1A, 0x0B, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0xCC, 0xFE, 0xED, 0xFF, 0xEF, 0xFF, 0xFF, 0xFA, 0xFF, 0xEF, 0xEF, 0xDE, 0xF7, 0x9F, 0xFA, 0xF0,
+	0x80, 0x20, 0xE0, 0xC1, 0x43, 0x2F, 0x1F, 0x2A, 0x2B, 0x1F, 0x2F, 0xC0, 0xE0, 0x40, 0xF0, 0x78,
+	0xF0, 0xF8, 0xFC, 0xD4, 0xE6, 0xFC, 0xF8, 0xFE, 0xFE, 0xFE, 0xFC, 0xFC, 0xF8, 0xE0, 0xC0, 0x80,
+	0x01, 0x05, 0x0D, 0x1F, 0x3F, 0x0F, 0x7F, 0x7F, 0x7F, 0x7F, 0x2F, 0x7F, 0x3F, 0x3F, 0x3F, 0x0E,
+	0x1F, 0x0E, 0x07, 0x03, 0x06, 0xC5, 0xC8, 0x78, 0xE8, 0xF8, 0xE4, 0xC3, 0x85, 0x05, 0x05, 0x06,
+	0x0F, 0x5F, 0xFD, 0xED, 0xE5, 0xF7, 0xB7, 0xFF, 0xBF, 0xBF, 0x4F, 0x7F, 0xFF, 0xF7, 0x73, 0x37,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0xF0, 0xF8, 0xF8,
+	0xFC, 0x3C, 0xE0, 0xB8, 0xFF, 0xFB, 0xE7, 0xFF, 0xFF, 0xFE, 0xFE, 0xFF, 0xFE, 0xB8, 0xD0, 0x00,
+	0x00, 0x00, 0x00, 0x02, 0x06, 0x0F, 0x1B, 0x1F, 0x1F, 0x1F, 0x1B, 0x0F, 0x07, 0x03, 0x01, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x0B, 0x1C, 0x3F, 0x7F,
+	0x0F, 0x2C, 0x77, 0xEF, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x7F, 0x3F, 0x1B, 0x02, 0x03, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 56.25 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0xF8, 0xF8, 0xFC, 0xFE, 0xFC, 0xFE, 0xFC, 0xFE, 0xFA, 0xFE,
+	0xFE, 0xFC, 0xF8, 0x70, 0x70, 0xE0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x80, 0xE0, 0xF0, 0xD8, 0xF8, 0xFE, 0xFE, 0xEE, 0x5E, 0xFF, 0xFE, 0xFE, 0xE4, 0xE0, 0x80,
+	0x00, 0x00, 0x00, 0x00, 0x5F, 0xBC, 0xBF, 0xBF, 0xFF, 0xFF, 0xFF, 0xBF, 0xFF, 0x3F, 0xFF, 0x7F,
+	0x7B, 0x7F, 0x1F, 0x7B, 0x2B, 0x1F, 0x1F, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x3E, 0x9F, 0xFE, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFD, 0xF7, 0xF7, 0xEF, 0xF7, 0x3E,
+	0xD4, 0xB0, 0xD8, 0xE0, 0x40, 0x21, 0x0F, 0x1F, 0x08, 0x3B, 0x3F, 0xC7, 0xC5, 0x81, 0xC0, 0x60,
+	0xE0, 0xE0, 0xE0, 0xF0, 0xD0, 0xD0, 0xE0, 0xC0, 0xF0, 0xE0, 0xE0, 0xC0, 0xC0, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x03, 0x05, 0x07, 0x0F, 0x0F, 0x0D, 0x0D, 0x0F, 0x0F, 0x0F, 0x07, 0x07,
+	0x07, 0x03, 0x83, 0xA1, 0xC1, 0xA4, 0xF8, 0xE8, 0xF8, 0xC8, 0x84, 0x07, 0x03, 0x1A, 0x02, 0x3E,
+	0x7F, 0xFF, 0xF7, 0x56, 0x7F, 0xBF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x7F, 0x3E, 0xFA, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xF8, 0xBC, 0xEC, 0xFE, 0xFE, 0x2E, 0xEA,
+	0xD8, 0xFD, 0xF7, 0xFD, 0xF7, 0xFF, 0xFF, 0xFF, 0xEE, 0xFF, 0x7F, 0xF0, 0x00, 0x00, 0x00, 0x00,
+	0x01, 0x0B, 0x3B, 0x1F, 0xFC, 0xFF, 0xFF, 0xFD, 0x77, 0x76, 0x37, 0x1F, 0x0F, 0x07, 0x01, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x0F, 0x17, 0x0B, 0x3D, 0x77,
+	0x5F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x1F, 0x3F, 0x1F, 0x13, 0x04, 0x01, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 67.5 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0xC0, 0xC0, 0xC0, 0x80, 0x80, 0xC0, 0x80,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0xE0, 0xF8, 0xF0, 0xF8, 0xFC, 0xF8, 0xFC,
+	0xF8, 0xF8, 0xF4, 0xF8, 0xF0, 0xF0, 0xA0, 0x80, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0xA0, 0xE0, 0xFE, 0xEE, 0xFE, 0xDF, 0xFF, 0xFF, 0xFD, 0xE7, 0x7F, 0xFF, 0xFF, 0x73,
+	0xFC, 0x40, 0x00, 0x00, 0x00, 0x00, 0x52, 0xDD, 0xBE, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF,
+	0x5F, 0xFF, 0xCF, 0xFF, 0xFF, 0xF7, 0x5D, 0x7B, 0xF7, 0x7E, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x03, 0x1E, 0x3F, 0xDF, 0xFF, 0xFF, 0xFF, 0xBF, 0xFF, 0xFF, 0xFF, 0xFD, 0xFB, 0xDD,
+	0xFF, 0xF3, 0xC8, 0xBC, 0xA0, 0xA0, 0x10, 0x0F, 0x3F, 0x2B, 0x35, 0xDF, 0x8F, 0x0B, 0x83, 0x82,
+	0x81, 0x81, 0x81, 0xC1, 0x02, 0x81, 0xC1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x83, 0x81, 0xC1, 0x83, 0x83, 0x01, 0x81,
+	0x81, 0xC1, 0xD1, 0xE2, 0xA2, 0xFC, 0xE8, 0xE8, 0xC8, 0x08, 0x04, 0x0F, 0x37, 0x05, 0xF2, 0xFE,
+	0xFF, 0xDF, 0x5F, 0xFB, 0xFF, 0xFC, 0xFF, 0xFE, 0xFF, 0xFF, 0xFF, 0xFC, 0xEC, 0xA0, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x7E, 0xF7, 0xFF, 0xFD, 0xEF, 0x5F, 0xF3, 0xFF, 0xEE, 0xFF,
+	0xFA, 0xFE, 0xFB, 0xFF, 0xFF, 0xFF, 0xEE, 0x7F, 0xFF, 0x40, 0x00, 0x00, 0x00, 0x00, 0x12, 0x6F,
+	0xFE, 0x7D, 0xF6, 0xFC, 0xFF, 0xEF, 0xBF, 0xB7, 0xFF, 0x7F, 0x77, 0x77, 0x0B, 0x05, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x02, 0x0F, 0x0F, 0x15, 0x3F, 0x1F, 0x3F,
+	0x3F, 0x3F, 0x1F, 0x1F, 0x1F, 0x13, 0x07, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x03, 0x03, 0x07, 0x06, 0x03, 0x03, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{ // 78.75 degrees
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xC0, 0xA0, 0xF0, 0xF0, 0xE0, 0xF0, 0x78, 0xF0,
+	0xE0, 0xF0, 0xC0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xE0, 0xF0, 0xE0,
+	0xF0, 0xF0, 0xE0, 0xF0, 0xE0, 0xE0, 0xA0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xB8, 0xFE, 0xFE, 0xFF, 0xFD, 0xFB, 0xFF, 0xFF, 0xFF, 0xFB, 0x5D, 0xFF,
+	0x7F, 0xDB, 0xFD, 0x32, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xBE, 0xBD, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0x7F, 0xFF, 0x3F, 0xFF, 0xFF, 0xBF, 0xDF, 0xDF, 0xFC, 0xBC, 0xC0, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x01, 0x05, 0x0F, 0x1F, 0x3F, 0x7F, 0x6F, 0x7F, 0x7F, 0xFF, 0x7F, 0xFF,
+	0x77, 0x7F, 0xEB, 0x54, 0xFC, 0x50, 0x10, 0x00, 0x1C, 0x3F, 0x3B, 0xF5, 0x3F, 0x1F, 0x0F, 0x06,
+	0x05, 0x07, 0x05, 0x0F, 0x07, 0x0B, 0x0F, 0x0B, 0x06, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x80, 0x80, 0xC0, 0xE0, 0xB0, 0xF0, 0xF0, 0xF0, 0xE0, 0xB0, 0xC0, 0xA0, 0x40,
+	0xE0, 0xF0, 0xF8, 0xD1, 0xF6, 0xE8, 0xF0, 0x08, 0x08, 0x08, 0x18, 0x37, 0x4F, 0xE8, 0xF6, 0xFA,
+	0xFF, 0x7E, 0xEE, 0xFE, 0xEA, 0xFA, 0xFE, 0xF0, 0xF8, 0xF0, 0xE0, 0xC0, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x02, 0x3F, 0x5E, 0x5F, 0xFF, 0xED, 0xBB, 0xFC, 0xFF, 0xFD, 0xFF, 0xFE, 0xFF,
+	0xFD, 0xFF, 0xFF, 0xF7, 0x7F, 0xFE, 0x6F, 0x01, 0x00, 0x00, 0x00, 0x00, 0xEC, 0xDF, 0xFB, 0xF7,
+	0xD9, 0xFB, 0xBF, 0xFF, 0xBF, 0xFF, 0xFF, 0xBF, 0x7F, 0xBF, 0x7F, 0x1A, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x02, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x07, 0x0F,
+	0x0F, 0x0B, 0x03, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x04, 0x0F, 0x1F,
+	0x1F, 0x17, 0x0E, 0x0F, 0x0D, 0x0F, 0x07, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef __HISTORY_H__
+#define __HISTORY_H__
+
+/*
+ * History log: what the unit was doing over the last hours
+ *
+ * Every historyPeriod seconds main.c takes a sample (temperature, duty,
+ * mode flags, loop overruns) and history_add() packs it into a
+ * HISTORY_SIZE byte SRAM log:
+ *
+ *     keyframe  tag 0x80|rep<<4|HISTORY_KEY_*, interval (varint, s),
+ *               stamp (3 bytes, s since boot), temp, duty, flags, overruns
+ *     delta     tag mask|rep<<4, then per mask bit, in order:
+ *               temp, duty (zigzag varint deltas), flags (byte),
+ *               overruns (varint, present only when non-zero)
+ *
+ * rep counts the further identical samples (same values, no overruns) the
+ * entry stands for, so a steady state costs one byte per 8 samples. Each
+ * block starts with a keyframe and holds samples interval seconds apart;
+ * a block is closed at HISTORY_BLOCK bytes.
+ *
+ * When the log is full the blocks in its older half are downsampled:
+ * neighbouring samples are merged pairwise (the first one's values, the
+ * overruns added) and the block's interval doubles. Blocks that keep
+ * getting older keep getting coarser; a block already at
+ * HISTORY_MAX_INTERVAL is dropped instead.
+ *
+ * Every HISTORY_CHECKPOINT_MIN minutes (or on CMD_HISTORY) the log is
+ * copied to EEPROM in the background, one byte per tick like settings.c,
+ * alternating between two slots so a copy cut short by a reset leaves the
+ * previous one. history_init() restores the newest good copy; stamps then
+ * restart from 0 in a new block marked HISTORY_KEY_BOOT.
+ *
+ * The clock stops in standby, so the first block after a wake is marked
+ * HISTORY_KEY_WAKE: the time between it and the block before is unknown.
+ *
+ * CMD_HISTORY 0 streams the log on USART0: a HISTORY_INFO frame (used,
+ * 2 bytes; now, 3 bytes; historyPeriod), then HISTORY_DATA frames (offset,
+ * 2 bytes; up to HISTORY_CHUNK log bytes). If the log is compacted while
+ * it is being sent, the dump starts over with a new HISTORY_INFO.
+ * tools/history.py decodes it -- keep the two in sync.
+ */
+
+#define HISTORY_SIZE 384
+#define HISTORY_BLOCK 48              // bytes, then a new keyframe
+#define HISTORY_PERIOD_S 10           // default historyPeriod
+#define HISTORY_MAX_INTERVAL 0xFFFFUL // s, coarsest a block gets
+#define HISTORY_CHECKPOINT_MIN 60     // 0: only on command
+
+#define HISTORY_INFO 0x12
+#define HISTORY_DATA 0x13
+#define HISTORY_CHUNK 24
+
+// Keyframe flags
+#define HISTORY_KEY_BOOT 0x01 // first block since reset
+#define HISTORY_KEY_WAKE 0x02 // first block after standby
+
+// Delta mask
+#define HISTORY_TEMP     0x01
+#define HISTORY_DUTY     0x02
+#define HISTORY_FLAGS    0x04
+#define HISTORY_OVERRUNS 0x08
+
+typedef struct {
+    unsigned char temp;     // zone 0's temp
+    unsigned char duty;     // motor duty, percent
+    unsigned char flags;    // TELEMETRY_* (telemetry.h) without TELEMETRY_MOTOR
+    unsigned char overruns; // loop overruns since the last sample
+} history_sample_t;
+
+extern unsigned char historyPeriod; // s between samples, 0 stops sampling
+
+/*
+ * Restore the last checkpoint, if any
+ */
+void history_init(void);
+
+/*
+ * Call every second. Returns 1 when a sample is due.
+ */
+unsigned char history_second(void);
+
+void history_add(const history_sample_t *s);
+
+/*
+ * The next sample starts a block marked HISTORY_KEY_WAKE
+ */
+void history_wake(void);
+
+void history_clear(void);
+void history_dump(void);
+void history_checkpoint(void);
+
+/*
+ * Dump frames and checkpoint bytes, call every 1 ms
+ */
+void history_Tick(void);
+
+/*
+ * 1 while a dump or a checkpoint is in progress
+ */
+unsigned char history_busy(void);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __INPUT_H__
+#define __INPUT_H__
+
+#include "evq.h"
+#include "zone.h"
+
+/*
+ * Interrupt-driven inputs on PINA
+ *
+ * PA0-3 buttons (active low) and PA4 the IR receiver share PCINT0. Button
+ * presses are debounced in the ISR and posted as EV_KEY; IR frames (NEC) are
+ * decoded from the edge timing and posted as EV_IR. Tasks drain inputQueue.
+ */
+
+#define INPUT_BUTTONS 0x0F
+#if ZONES > 3
+#define INPUT_IR      0x00 // PA4 is zone 3's thermistor, no remote
+#else
+#define INPUT_IR      0x10 // PA4, RECEIVER in IR.h
+#endif
+#define INPUT_DEBOUNCE_MS 20
+
+extern evq_t inputQueue;
+
+void input_init(void);
+
+/*
+ * Decode a new PINA value seen at time now (ticks_now() counts). Called by
+ * the pin change ISR, and by replay.c with recorded values; interrupt
+ * context only, as it posts to inputQueue.
+ */
+void input_pins(unsigned char pin, unsigned long now);
+
+#endif
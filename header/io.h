@@ -1,12 +1,35 @@
 #ifndef __io_h__
 #define __io_h__
 
+#include "zone.h"
+
+#if ZONES > 1
+// Multi-zone boards have no HD44780, its pins drive zones (zone.h)
+#define LCD_Display(on) ((void)0)
+#define LCD_Cursor(column) ((void)0)
+#define LCD_WriteData(Data) ((void)0)
+#define LCD_init_Tick() 1
+#define LCD_DisplayString_Tick(column, string) 1
+#define LCD_PutCommand(Command) ((void)0)
+#define LCD_PutData(Data) ((void)0)
+#else
+
 void LCD_init();
 void LCD_ClearScreen(void);
+void LCD_Display(unsigned char on);
 void LCD_WriteCommand (unsigned char Command);
 void LCD_Cursor (unsigned char column);
 void LCD_WriteData (unsigned char Data);
 void LCD_DisplayString(unsigned char column ,const unsigned char *string);
 void delay_ms(int miliSec);
 
+// Non-blocking variants, one call per 1 ms scheduler tick
+unsigned char LCD_init_Tick(void); // returns 1 once the display is ready
+// LCD_DisplayString one write per tick; call with the same arguments until
+// it returns 1, the call after that starts the next string
+unsigned char LCD_DisplayString_Tick(unsigned char column, const unsigned char *string);
+void LCD_PutCommand(unsigned char Command);
+void LCD_PutData(unsigned char Data);
+#endif
+
 #endif
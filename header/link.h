@@ -0,0 +1,61 @@
+#ifndef __LINK_H__
+#define __LINK_H__
+
+/*
+ * Display link (split build, see "make split")
+ *
+ * In the split build the control MCU (main.c built with -DDISPLAY_LINK) has
+ * no LCD driver. A second ATmega1284 (display/display.c) owns both Nokia
+ * displays and renders locally; the control MCU only tells it what
+ * changed, over the SPI:
+ *
+ *     control PB5 MOSI -> display PB5 MOSI
+ *     control PB7 SCK  -> display PB7 SCK
+ *     control PB0      -> display PB4 SS (low while bytes are queued)
+ *
+ * Frames are the uart.h format: 0xA5 0x5A len type payload[len] crc8. The
+ * bytes are queued in a ring and clocked out by the SPI interrupt, so
+ * sending costs the control MCU a few microseconds per byte of ISR time
+ * and no rendering at all. The link is one way: the display MCU drops
+ * frames with a bad CRC, and the control MCU sends its whole state again
+ * every LINK_REFRESH_MS so a lost frame or a display MCU reset heals.
+ */
+
+#define LINK_TX_SIZE 64   // power of two
+#define LINK_MAX 16       // longest payload
+#define LINK_REFRESH_MS 1000
+
+// Frame types
+#define LINK_STATUS 0x20 // field/value pairs, as many as fit
+#define LINK_FRAME  0x21 // fan animation frame index (fanframes.h)
+#define LINK_TEXT   0x22 // status display line (0-5), then up to LINK_TEXT_MAX characters
+#define LINK_POWER  0x23 // 0 both displays powered down, 1 on
+
+// LINK_STATUS fields
+#define LINK_FIELD_POWER 0 // 0/1
+#define LINK_FIELD_OSC   1 // 0/1
+#define LINK_FIELD_TEMP  2 // temperature mode 0/1
+#define LINK_FIELD_SPEED 3 // speed shown, 1 .. maxSpeed
+#define LINK_FIELDS      4
+
+#define LINK_TEXT_MAX 14 // fixed font characters per line
+
+#ifdef DISPLAY_LINK
+
+extern volatile unsigned char linkDropped; // frames that didn't fit the ring
+
+void link_init(void);
+
+/*
+ * Queue a whole frame or nothing. Returns 0 when there isn't room.
+ */
+unsigned char link_send(unsigned char type, const void *payload, unsigned char len);
+
+/*
+ * 1 once everything queued has been clocked out
+ */
+unsigned char link_idle(void);
+
+#endif
+
+#endif
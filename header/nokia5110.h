@@ -34,65 +34,237 @@
 
 /*
  * LCD's pins
+ * CLK, DIN, DC and RST are shared by every display on the bus,
+ * each display has its own chip-select (SCE).
+ * DIN and CLK are the hardware SPI's MOSI and SCK. SS (PB4) must stay an
+ * output or the SPI drops out of master mode; it drives the HD44780's RS
+ * (io.c). MISO (PB6) is unused.
+ * The display MCU of the split build (-DNOKIA_USART, display/display.c)
+ * has its SPI on the control link (link.h), so there the bus runs on
+ * USART1 in master SPI mode: DIN on TXD1, CLK on XCK1.
  */
-#define LCD_SCE PB1
+#define LCD_SCE PB1  /* fan animation display */
+#define LCD_SCE2 PB0 /* status display */
 #define LCD_RST PB2
 #define LCD_DC PB3
-#define LCD_DIN PB4
-#define LCD_CLK PB5
+#ifdef NOKIA_USART
+#define LCD_DIN PD3  /* TXD1 */
+#define LCD_CLK PD4  /* XCK1 */
+#define PORT_LCD_BUS PORTD
+#else
+#define LCD_DIN PB5  /* MOSI */
+#define LCD_CLK PB7  /* SCK */
+#define PORT_LCD_BUS PORTB
+#endif
+
+/*
+ * The same pins for pins.h
+ */
+#define LCD_SCE_PIN PORT_LCD, LCD_SCE
+#define LCD_SCE2_PIN PORT_LCD, LCD_SCE2
+#define LCD_RST_PIN PORT_LCD, LCD_RST
+#define LCD_DC_PIN PORT_LCD, LCD_DC
+#define LCD_DIN_PIN PORT_LCD_BUS, LCD_DIN
+#define LCD_CLK_PIN PORT_LCD_BUS, LCD_CLK
+#define LCD_SS_PIN PORT_LCD, PB4
 
 #define LCD_CONTRAST 0x40
 
 /*
- * Must be called once before any other function, initializes display
+ * Fonts for nokia_lcd_set_font
+ */
+#define NOKIA_FONT_FIXED 0 /* 5x7 CHARSET, 6px advance */
+#define NOKIA_FONT_PROP  1 /* packed proportional, see tools/fontpack.py */
+
+/*
+ * Bus arbiter
+ */
+#define NOKIA_MAX_PANELS 2
+#define NOKIA_BUS_CHUNK 32 /* bytes sent per nokia_bus_Tick() */
+
+/*
+ * Renderer, chosen at compile time:
+ *
+ * frame buffer (default) - drawing goes into a 504 byte screen per display,
+ *   a flush sends it.
+ * streaming (-DNOKIA_STREAM, make NOKIASTREAM=1) - drawing only records
+ *   draw items (PROGMEM bitmaps and glyph runs); a flush generates every
+ *   byte bank by bank, straight into SPDR while the previous one shifts
+ *   out. No frame buffer, so ~380 bytes of SRAM less per display. Draws
+ *   are bank aligned (cursor_y is rounded down to a multiple of 8), text
+ *   is drawn at scale 1, a later item covers an earlier one, and
+ *   set_pixel/write_bitmap (RAM bitmaps) are not available. A RAM string
+ *   costs one item per character, a PROGMEM string one per line it covers.
+ */
+#define NOKIA_MAX_ITEMS 8 /* draw items per display, more are dropped */
+
+#define NOKIA_ITEM_BITMAP 0
+#define NOKIA_ITEM_TEXT   1
+
+/*
+ * Draw item of the streaming renderer
+ */
+typedef struct nokia_item {
+    /* bitmap or string in flash, NULL for a single character */
+    const uint8_t *data;
+    uint8_t kind;
+
+    /* covered area: columns x .. x + width - 1, banks bank .. bank + banks - 1 */
+    uint8_t x;
+    uint8_t width;
+    uint8_t bank;
+    uint8_t banks;
+
+    /* bitmap: bytes per bank; text: characters */
+    uint8_t len;
+
+    /* text: NOKIA_FONT_*, the character when data is NULL */
+    uint8_t font;
+    char code;
+
+    /* text: glyph being streamed, column in it, next character */
+    const uint8_t *glyph;
+    uint8_t glyph_width;
+    uint8_t col;
+    uint8_t next;
+} nokia_item_t;
+
+/*
+ * One display: frame buffer (or draw items), cursor and bus state
+ */
+typedef struct nokia_lcd {
+#ifdef NOKIA_STREAM
+    /* draw items, in drawing order */
+    nokia_item_t items[NOKIA_MAX_ITEMS];
+    uint8_t item_count;
+
+    /* position of the next streamed byte */
+    uint8_t stream_x;
+    uint8_t stream_bank;
+#else
+    /* screen byte massive */
+    uint8_t screen[504];
+#endif
+
+    /* cursor position */
+    uint8_t cursor_x;
+    uint8_t cursor_y;
+
+    /* NOKIA_FONT_FIXED or NOKIA_FONT_PROP */
+    uint8_t font;
+
+    /* chip-select pin on PORT_LCD, LCD_SCE or LCD_SCE2 */
+    uint8_t sce;
+
+    /* flush priority, higher is sent first */
+    uint8_t priority;
+
+    /* flush requested / transfer in progress, next byte to send */
+    volatile uint8_t dirty;
+    uint8_t sending;
+    uint16_t flush_pos;
+
+    /* display blanked until the first frame has been sent */
+    uint8_t blank;
+
+    /* frames completely sent to the display */
+    uint16_t frames;
+} nokia_lcd_t;
+
+/*
+ * Resets every display on the bus without blocking (10 ms + 70 ms).
+ * Call every 1 ms until it returns 1, before any other function.
+ */
+uint8_t nokia_bus_init_Tick(void);
+
+/**
+ * Initializes one display and registers it with the bus arbiter.
+ * Only the setup commands are sent here; the RAM clear goes through
+ * the arbiter and the display stays blank until it has finished.
+ * @lcd: display
+ * @sce: chip-select pin on PORT_LCD, LCD_SCE or LCD_SCE2
+ * @priority: flush priority, higher is sent first
  */
-void nokia_lcd_init(void);
+void nokia_lcd_init(nokia_lcd_t *lcd, uint8_t sce, uint8_t priority);
 
 /*
- * Clear screen
+ * Clear frame buffer
  */
-void nokia_lcd_clear(void);
+void nokia_lcd_clear(nokia_lcd_t *lcd);
 
 /**
  * Power of display
  * @lcd: lcd nokia struct
  * @on: 1 - on; 0 - off;
  */
-// void nokia_lcd_power(uint8_t on);
+void nokia_lcd_power(nokia_lcd_t *lcd, uint8_t on);
 
+#ifndef NOKIA_STREAM
 /**
  * Set single pixel
  * @x: horizontal pozition
  * @y: vertical position
  * @value: show/hide pixel
  */
-void nokia_lcd_set_pixel(uint8_t x, uint8_t y, uint8_t value);
+void nokia_lcd_set_pixel(nokia_lcd_t *lcd, uint8_t x, uint8_t y, uint8_t value);
+#endif
+
+/**
+ * Select the font used by write_char/write_string
+ * @font: NOKIA_FONT_FIXED or NOKIA_FONT_PROP
+ */
+void nokia_lcd_set_font(nokia_lcd_t *lcd, uint8_t font);
 
 /**
  * Draw single char with 1-6 scale
+ * Scale 1 at a cursor_y that is a multiple of 8 copies the glyph
+ * columns straight into the bank row (fast path).
  * @code: char code
  * @scale: size of char
  */
-// void nokia_lcd_write_char(char code, uint8_t scale);
+void nokia_lcd_write_char(nokia_lcd_t *lcd, char code, uint8_t scale);
 
 /**
  * Draw string. Example: writeString("abc",3);
  * @str: sending string
  * @scale: size of text
  */
-// void nokia_lcd_write_string(const char *str, uint8_t scale);
+void nokia_lcd_write_string(nokia_lcd_t *lcd, const char *str, uint8_t scale);
 
 /**
- * Set cursor position
+ * Draw string stored in flash. Example: writeString_P(PSTR("abc"),1);
+ * @str: sending string (PROGMEM)
+ * @scale: size of text
+ */
+void nokia_lcd_write_string_P(nokia_lcd_t *lcd, const char *str, uint8_t scale);
+
+/**
+ * Set cursor position; a position off the 84x48 screen is ignored
  * @x: horizontal position
  * @y: vertical position
  */
-void nokia_lcd_set_cursor(uint8_t x, uint8_t y);
+void nokia_lcd_set_cursor(nokia_lcd_t *lcd, uint8_t x, uint8_t y);
+
+/*
+ * Render screen to display (blocking, whole frame)
+ */
+void nokia_lcd_render(nokia_lcd_t *lcd);
+
+/*
+ * Queue the frame buffer for the bus arbiter (non-blocking)
+ */
+void nokia_lcd_flush(nokia_lcd_t *lcd);
 
 /*
- * Render screen to display
+ * Send the next chunk of the highest priority pending flush
+ * Call once per scheduler tick.
  */
-void nokia_lcd_render(void);
+void nokia_bus_Tick(void);
+
+/*
+ * 1 while any display still has a flush pending or in progress
+ */
+uint8_t nokia_bus_busy(void);
 
 
 
@@ -100,7 +272,18 @@ void nokia_lcd_render(void);
  * Other custom functions
  */
 
+#ifndef NOKIA_STREAM
 // setBitMap
-void nokia_lcd_write_bitmap(const unsigned char bitMap[]);
+void nokia_lcd_write_bitmap(nokia_lcd_t *lcd, const unsigned char bitMap[]);
+#endif
+
+/**
+ * Copy a bitmap stored in flash into the frame buffer at the cursor,
+ * one bank row at a time (cursor_y should be a multiple of 8)
+ * @bitmap: banks * width bytes, bank after bank (PROGMEM)
+ * @width: columns per bank
+ * @banks: number of 8 pixel rows
+ */
+void nokia_lcd_write_bitmap_P(nokia_lcd_t *lcd, const uint8_t *bitmap, uint8_t width, uint8_t banks);
 
 #endif
@@ -0,0 +1,63 @@
+#ifndef __ONEWIRE_H__
+#define __ONEWIRE_H__
+
+/*
+ * 1-Wire temperature sensor (DS18B20 class) on PA7, for units without the
+ * thermistor (built with -DTEMP_ONEWIRE, "make ONEWIRE=1")
+ *
+ * DQ is open drain: PORTA7 stays 0 and the pin is pulled low by making it
+ * an output, released by making it an input (4.7k pull-up to VCC, sensor
+ * powered from VCC, not parasitic). Only one sensor on the bus (skip ROM).
+ *
+ * Timer2 (CTC, 1 us per count) steps through a whole transaction in its
+ * compare ISR, one compare per reset phase or time slot, so starting one
+ * costs the caller nothing and the main loop never waits on the bus. A
+ * transaction is about 2 ms (convert) or 7 ms (read scratchpad). The
+ * 750 ms conversion itself runs in the sensor between two transactions;
+ * T_Tick in main.c starts it, comes back when it's done and collects it.
+ *
+ * Timer2 runs only during a transaction and is stopped (and can be gated)
+ * between them.
+ */
+
+#if defined(TEMP_ONEWIRE) && defined(REPLAY)
+#error "input traces record the thermistor's ADC samples, replay without TEMP_ONEWIRE"
+#endif
+
+#define ONEWIRE_CONVERT_MS 750 // 12-bit conversion time
+
+// onewire_status()
+#define ONEWIRE_IDLE      0 // nothing started yet
+#define ONEWIRE_BUSY      1
+#define ONEWIRE_DONE      2
+#define ONEWIRE_NO_DEVICE 3 // no presence pulse after the reset
+#define ONEWIRE_BAD_CRC   4 // scratchpad CRC failed, or the power-on 85 C value
+
+extern volatile unsigned char onewireErrors; // transactions not ending ONEWIRE_DONE
+
+void onewire_init(void);
+
+/*
+ * Start a conversion: reset, skip ROM, convert T. Returns 0 when a
+ * transaction is still running.
+ */
+unsigned char onewire_convert(void);
+
+/*
+ * Start reading the result: reset, skip ROM, read scratchpad (9 bytes).
+ * Returns 0 when a transaction is still running.
+ */
+unsigned char onewire_read(void);
+
+/*
+ * ONEWIRE_* state of the last transaction started
+ */
+unsigned char onewire_status(void);
+
+/*
+ * After a read ended ONEWIRE_DONE: the temperature in the units of
+ * a zone's temp (the thermistor divider's ADC reading, see onewire.c)
+ */
+unsigned char onewire_sample(void);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __OUTPUT_H__
+#define __OUTPUT_H__
+
+#include <avr/io.h>
+#include "zone.h"
+
+/*
+ * Shadow-register output stage
+ *
+ * Task-level outputs aren't written to the ports directly. Each owner below
+ * holds a bitmask of one port and updates only those bits of the port's
+ * shadow with out_set(). out_commit() runs once per tick after the
+ * foreground tasks (fg_Tick in main.c, in the Timer1 ISR) and writes every
+ * port whose shadow changed with a single store:
+ *
+ *     PORTx = (PORTx & ~OUT_MASK_x) | shadow
+ *
+ * with interrupts masked for just that read and store. Bits outside
+ * OUT_MASK_x -- the LCD buses, which their drivers strobe with sbi/cbi in
+ * the middle of a tick, and the input pull-ups -- are carried over as they
+ * are, so the HD44780's E line on PD7 is no longer cleared by the motor
+ * outputs, and an output several tasks touch in one tick moves only once.
+ * As the commit can land in the middle of any background code, that code
+ * may touch PORTA and PORTD only with single sbi/cbi (pins.h).
+ */
+
+#define OUT_A 0 // PORTA
+#define OUT_D 1 // PORTD
+#define OUT_PORTS 2
+
+// Owners
+#if ZONES > 1
+#define OUT_LEDS_MASK  0x00                                   // PA5/PA6 are zone thermistors (zone.h)
+#elif defined(BUS_NODE)
+#define OUT_LEDS_MASK  (1 << PA5)                             // OUT_A: zone 0 on; PA6 is the bus DE (bus.h)
+#else
+#define OUT_LEDS_MASK  ((1 << PA5) | (1 << PA6))              // OUT_A: zone 0 on, oscillateOn
+#endif
+#define OUT_SERVO_MASK (1 << PD2)                             // OUT_D: servo pulse
+#define OUT_MOTOR_MASK ((1 << PD3) | (1 << PD4) | (1 << PD5)) // OUT_D: motor enable, direction
+
+#define OUT_MASK_A OUT_LEDS_MASK
+#define OUT_MASK_D (OUT_SERVO_MASK | OUT_MOTOR_MASK)
+
+#if (OUT_SERVO_MASK & OUT_MOTOR_MASK) != 0
+#error "output owners overlap on PORTD"
+#endif
+#if (OUT_MASK_D & ((1 << PD0) | (1 << PD1) | (1 << PD6) | (1 << PD7))) != 0
+#error "PORTD outputs overlap USART0, the tach input or the HD44780 E line"
+#endif
+
+extern volatile unsigned char outShadow[OUT_PORTS];
+
+/*
+ * Take the shadows from the ports as main() left them
+ */
+void out_init(void);
+
+/*
+ * Set the bits of mask in a port's shadow to value. Safe from tasks and
+ * ISRs; nothing reaches the pins until out_commit().
+ */
+static inline void out_set(unsigned char port, unsigned char mask, unsigned char value) {
+    unsigned char sreg = SREG;
+
+    __asm__ __volatile__ ("cli" ::: "memory");
+    outShadow[port] = (outShadow[port] & ~mask) | (value & mask);
+    SREG = sreg;
+}
+
+/*
+ * Write the changed shadows to the ports, one store per port
+ */
+void out_commit(void);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __PINS_H__
+#define __PINS_H__
+
+#include <avr/io.h>
+#include <stdint.h>
+
+/*
+ * Compile-time pin access
+ *
+ * A pin is a port and a bit, both constants, named once:
+ *
+ *     #define LCD_E_PIN PORTD, 7
+ *
+ *     PIN_HIGH(LCD_E_PIN);     sbi  PORTD, 7
+ *     PIN_LOW(LCD_E_PIN);      cbi  PORTD, 7
+ *     PIN_OUTPUT(LCD_E_PIN);   sbi  DDRD, 7
+ *     PIN_INPUT(LCD_E_PIN);    cbi  DDRD, 7
+ *     PIN_IS_HIGH(LCD_E_PIN)   in   PIND (and a bit test)
+ *     PORT_WRITE(PORTC, v);    out  PORTC, v
+ *     PORT_READ(PORTD)         in   PORTD
+ *
+ * Every access is one instruction at any optimisation level. The Makefile
+ * builds with -O0, where "PORTD |= 1 << 7" is a multi-instruction
+ * read-modify-write through a pointer register that an ISR touching the
+ * same port can tear; sbi/cbi are atomic. The operands go through "I"
+ * constraints, so a port outside the low I/O space or a bit that isn't a
+ * constant fails to compile instead of falling back to slow code.
+ *
+ * Building with -DPINS_GENERIC turns the same calls back into plain C
+ * port expressions, which is what "make pincheck" compares against.
+ */
+
+// Variadic so a pin that is already expanded ("PORTD, 7") passes through
+#define PIN_HIGH(...) PIN_HIGH_(__VA_ARGS__)
+#define PIN_LOW(...) PIN_LOW_(__VA_ARGS__)
+#define PIN_OUTPUT(...) PIN_OUTPUT_(__VA_ARGS__)
+#define PIN_INPUT(...) PIN_INPUT_(__VA_ARGS__)
+#define PIN_IS_HIGH(...) PIN_IS_HIGH_(__VA_ARGS__)
+
+/*
+ * Pin to on (0/1, known at run time): a branch and one sbi or cbi
+ */
+#define PIN_SET(pin, on) do { if (on) PIN_HIGH(pin); else PIN_LOW(pin); } while (0)
+
+// DDRx sits one below PORTx and PINx two below on the ATmega1284
+#ifdef PINS_GENERIC
+
+#define PIN_HIGH_(port, bit) ((port) |= (1 << (bit)))
+#define PIN_LOW_(port, bit) ((port) &= ~(1 << (bit)))
+#define PIN_OUTPUT_(port, bit) ((&(port))[-1] |= (1 << (bit)))
+#define PIN_INPUT_(port, bit) ((&(port))[-1] &= ~(1 << (bit)))
+#define PIN_IS_HIGH_(port, bit) (((&(port))[-2] >> (bit)) & 1)
+#define PORT_WRITE(port, value) ((port) = (value))
+#define PORT_READ(port) (port)
+
+#else
+
+#define PIN_HIGH_(port, bit) \
+    __asm__ __volatile__ ("sbi %0, %1" :: "I" (_SFR_IO_ADDR(port)), "I" (bit) : "memory")
+#define PIN_LOW_(port, bit) \
+    __asm__ __volatile__ ("cbi %0, %1" :: "I" (_SFR_IO_ADDR(port)), "I" (bit) : "memory")
+#define PIN_OUTPUT_(port, bit) \
+    __asm__ __volatile__ ("sbi %0, %1" :: "I" (_SFR_IO_ADDR(port) - 1), "I" (bit) : "memory")
+#define PIN_INPUT_(port, bit) \
+    __asm__ __volatile__ ("cbi %0, %1" :: "I" (_SFR_IO_ADDR(port) - 1), "I" (bit) : "memory")
+#define PIN_IS_HIGH_(port, bit) ({ \
+    uint8_t pin_value_; \
+    __asm__ __volatile__ ("in %0, %1" : "=r" (pin_value_) : "I" (_SFR_IO_ADDR(port) - 2) : "memory"); \
+    (pin_value_ >> (bit)) & 1; })
+#define PORT_WRITE(port, value) \
+    __asm__ __volatile__ ("out %0, %1" :: "I" (_SFR_IO_ADDR(port)), "r" ((uint8_t)(value)) : "memory")
+#define PORT_READ(port) ({ \
+    uint8_t port_value_; \
+    __asm__ __volatile__ ("in %0, %1" : "=r" (port_value_) : "I" (_SFR_IO_ADDR(port)) : "memory"); \
+    port_value_; })
+
+#endif
+
+#endif
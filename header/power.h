@@ -0,0 +1,43 @@
+#ifndef __POWER_H__
+#define __POWER_H__
+
+/*
+ * Low-power standby
+ *
+ * power_init() gates the peripherals this firmware never uses. power_sleep()
+ * puts the core in POWER_DOWN with the ADC and USART gated as well, and
+ * returns once a button or the IR receiver (PCINT0-4 on PINA, enabled by
+ * input_init) changes, or when the watchdog period expires if a periodic
+ * wake was asked for.
+ *
+ * Wake latency: the wake interrupt stamps ticks_now(); the first control
+ * tick after waking calls power_responsive(), which stores the difference
+ * in powerWakeLatency (microseconds).
+ */
+
+#define POWER_WAKE_NONE 0
+#define POWER_WAKE_PIN  1 // button or IR edge
+#define POWER_WAKE_WDT  2 // periodic watchdog wake
+
+extern volatile unsigned char powerWake;
+extern unsigned long powerWakeLatency; // us, last wake to first responsive tick
+
+void power_init(void);
+
+/*
+ * Sleep in POWER_DOWN until a pin change, or the ~8 s watchdog period when
+ * wdt is non-zero. Returns the POWER_WAKE_* reason.
+ */
+unsigned char power_sleep(unsigned char wdt);
+
+/*
+ * Called from the pin change ISR (input.c)
+ */
+void power_pinWake(void);
+
+/*
+ * Call from the first task tick that handles input after a wake
+ */
+void power_responsive(void);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __PT_H__
+#define __PT_H__
+
+/*
+ * Protothreads: stackless coroutines for the 1 ms scheduler
+ *
+ * Long operations (a display bring-up, a string written one character per
+ * tick) are written as straight-line code that yields where the blocking
+ * version would have waited, and is resumed from there on the next call:
+ *
+ *     static pt_t pt;
+ *     static unsigned char wait;
+ *
+ *     unsigned char LCD_init_Tick(void) {
+ *         PT_BEGIN(&pt);
+ *         PT_DELAY(&pt, wait, 100);  // power-on wait
+ *         LCD_PutCommand(0x38);
+ *         PT_YIELD(&pt);             // next write on the next tick
+ *         ...
+ *         PT_END(&pt);
+ *     }
+ *
+ * A thread returns PT_RUNNING while it has more to do and PT_DONE once it
+ * ran off its end, so it drops in wherever a *_Tick returned 1 when done.
+ * After PT_DONE it keeps returning PT_DONE until PT_INIT.
+ *
+ * The whole state is the pt_t: the line of the last yield, used as a case
+ * label of a switch that PT_BEGIN opens (local continuations). So:
+ *
+ *  - locals don't survive a yield; keep what is needed after one static
+ *    (or in the caller's struct) -- PT_DELAY's counter too
+ *  - no switch statement may enclose a yield inside a thread, its case
+ *    labels would be the thread's
+ *  - at most one yield per source line
+ */
+
+typedef unsigned short pt_t; // resume point, 0: from the start
+
+#define PT_RUNNING 0
+#define PT_DONE    1
+
+#define PT_INIT(pt) (*(pt) = 0)
+
+#define PT_LC_DONE 0xFFFF // ran off its end
+
+#define PT_BEGIN(pt) switch(*(pt)) { case PT_LC_DONE: return PT_DONE; case 0:
+
+#define PT_END(pt) } *(pt) = PT_LC_DONE; return PT_DONE
+
+/*
+ * As PT_END, but the next call starts the thread over (an operation the
+ * caller runs again and again, e.g. once per string)
+ */
+#define PT_END_RESTART(pt) } PT_INIT(pt); return PT_DONE
+
+/*
+ * Return now, carry on after this line on the next call
+ */
+#define PT_YIELD(pt) do { \
+    *(pt) = __LINE__; return PT_RUNNING; case __LINE__:; \
+} while(0)
+
+/*
+ * Return until cond holds; tested now and again on every call
+ */
+#define PT_WAIT_UNTIL(pt, cond) do { \
+    *(pt) = __LINE__; case __LINE__: \
+    if(!(cond)) return PT_RUNNING; \
+} while(0)
+
+/*
+ * Carry on ticks calls from now (ms when called every tick). counter is
+ * an unsigned char the thread owns and keeps across calls.
+ */
+#define PT_DELAY(pt, counter, ticks) do { \
+    (counter) = (ticks); \
+    PT_WAIT_UNTIL(pt, (counter)-- == 0); \
+} while(0)
+
+/*
+ * Run a child thread to completion, yielding while it runs
+ */
+#define PT_SPAWN(pt, child) PT_WAIT_UNTIL(pt, (child) == PT_DONE)
+
+#endif
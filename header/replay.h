@@ -0,0 +1,46 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+/*
+ * Input replay (simulation builds with -DREPLAY, see "make replay")
+ *
+ * A recorded input trace is compiled into flash (replaytrace.h, generated by
+ * tools/replay.py) and played back from the Timer1 compare ISR, one step per
+ * millisecond, in place of the real pins:
+ *
+ *     REPLAY_PINA  button levels, fed to input_pins() like a pin change
+ *     REPLAY_IR    NEC code, fed to input_pins() as the edges of a frame
+ *     REPLAY_ADC   temperature sample returned by later conversions
+ *
+ * so recorded presses go through the same debounce and IR decoding as on
+ * the board. Each record is due dt ms after the previous one. main.c logs
+ * the resulting outputs on the UART and stops the simulator once the trace
+ * has ended and REPLAY_SETTLE_MS have passed. A log line is only printed
+ * when the TX ring has room for all of it, else on a later tick, and the
+ * last line reports uartDropped so a log with bytes missing fails.
+ */
+
+#ifdef REPLAY
+
+#define REPLAY_WAIT 0 // no input, splits gaps longer than 65535 ms
+#define REPLAY_PINA 1
+#define REPLAY_IR   2
+#define REPLAY_ADC  3
+
+#define REPLAY_SETTLE_MS 10000 // run on after the last record
+#define REPLAY_LOG_LINE 88     // longest log line main.c prints, "\r\n" included
+
+typedef struct {
+    unsigned short dt;   // ms after the previous record
+    unsigned char kind;  // REPLAY_*
+    unsigned long value;
+} replay_record_t;
+
+extern volatile unsigned char replayAdc;  // current analog sample
+extern volatile unsigned char replayDone; // every record has been played
+
+void replay_Tick(void); // Timer1 compare ISR, every 1 ms
+
+#endif
+
+#endif
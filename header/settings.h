@@ -0,0 +1,53 @@
+#ifndef __SETTINGS_H__
+#define __SETTINGS_H__
+
+/*
+ * Persistent user settings
+ *
+ * EEPROM holds a ring of SETTINGS_SLOTS fixed-size records. Every save goes
+ * to the slot after the newest one, so wear is spread over the whole ring.
+ * Each record carries a sequence number and a CRC-8; a record that was only
+ * partly written when power failed fails its CRC and the previous one is
+ * used instead.
+ *
+ * settings_save() only stages a record. settings_Tick() waits until the
+ * settings have been left alone for SETTINGS_QUIET_MS, then writes the record
+ * one byte per call whenever the EEPROM is ready, so a burst of button presses
+ * costs one record and the main loop never waits on a 3.3 ms byte write.
+ */
+
+#define SETTINGS_VERSION 1
+#define SETTINGS_SLOTS 32      // 32 x 8 bytes at the start of EEPROM
+#define SETTINGS_QUIET_MS 2000 // settings_Tick() is called every 1 ms
+
+typedef struct {
+    unsigned char seq;           // newest record has the highest seq (mod 256)
+    unsigned char version;       // SETTINGS_VERSION
+    unsigned char fanOn;
+    unsigned char pos_speed;
+    unsigned char oscillateOn;
+    unsigned char tempMode;
+    unsigned char tempThreshold;
+    unsigned char crc;           // CRC-8 of the bytes above
+} settings_t;
+
+/*
+ * Scan the ring for the newest valid record (SETTINGS_SLOTS reads, bounded).
+ * Returns 1 and fills s if one was found, 0 if EEPROM holds no settings yet.
+ */
+unsigned char settings_load(settings_t *s);
+
+/*
+ * Stage s for writing. Only the data fields are used; seq, version and crc
+ * are filled in by the module. Unchanged settings are ignored.
+ */
+void settings_save(const settings_t *s);
+
+void settings_Tick(void);
+
+/*
+ * 1 while a record is staged or being written
+ */
+unsigned char settings_busy(void);
+
+#endif
@@ -12,15 +12,22 @@ AVR_MCU_VCD_FILE("build/results/custom_project_trace.vcd",1000);
 const struct avr_mmcu_vcd_trace_t _mytrace[] _MMCU_ = {
     { AVR_MCU_VCD_SYMBOL("PINA0"), .mask = 1 << 0,.what = (void*)&PINA, } , // Example individual pin
     { AVR_MCU_VCD_SYMBOL("PORTB"), .what = (void*)&PORTB, } , // Example full port
+    { AVR_MCU_VCD_SYMBOL("PINA"), .what = (void*)&PINA, } , // inputs, "tools/replay.py vcd" turns these into a replay trace
+    { AVR_MCU_VCD_SYMBOL("PORTA"), .what = (void*)&PORTA, } ,
+    { AVR_MCU_VCD_SYMBOL("PORTD"), .what = (void*)&PORTD, } ,
 };
 
+#include "uart.h"
+
 /* Function to output through UART */
+/* Queued on the interrupt-driven TX ring (uart.c) instead of spinning on  */
+/* UDRE0; output that doesn't fit is dropped and counted in uartDropped.   */
+/* Note printf text shares the line with the binary telemetry frames.      */
 static int uart_putchar(char c, FILE *stream) {
     if (c == '\n') {
         uart_putchar('\r',stream);
     }
-    loop_until_bit_is_set(UCSR0A,UDRE0);
-    UDR0 = c;
+    uart_putc(c);
     return 0;
 }
 
@@ -0,0 +1,34 @@
+#ifndef __STACK_H__
+#define __STACK_H__
+
+#include <stdint.h>
+
+/*
+ * Stack high-water-mark instrumentation
+ *
+ * Free SRAM between the end of .bss (_end) and the top of the stack (__stack)
+ * is painted with STACK_CANARY from .init1, before the C runtime sets up the
+ * stack. The deepest the stack has ever grown is found by counting the canary
+ * bytes that are still intact, starting from _end.
+ *
+ * stackFree holds the smallest headroom measured so far and can be read from
+ * gdb (print stackFree) or the python test harness (read('stackFree')).
+ */
+
+#define STACK_CANARY 0xC5
+#define STACK_SCAN_CHUNK 32 // bytes checked per stack_Tick() call
+
+extern volatile uint16_t stackFree; // untouched bytes between .bss and stack
+extern volatile uint16_t stackSize; // bytes available to the stack at boot
+
+/*
+ * Count the untouched canary bytes in one go (blocking, for gdb "call")
+ */
+uint16_t stack_unused(void);
+
+/*
+ * Incremental scan, STACK_SCAN_CHUNK bytes per call. Updates stackFree.
+ */
+void stack_Tick(void);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __TACH_H__
+#define __TACH_H__
+
+/*
+ * Fan tachometer on ICP1 (PD6)
+ *
+ * Timer1 already runs the 1 ms scheduler tick (CTC, 8 us per count), so
+ * each falling tach edge is captured in ICR1 and turned into a timestamp
+ * with ticks_at(). The last TACH_AVG periods are averaged into tachRpm.
+ * No edge for TACH_STALL_MS means the rotor is stopped (tachRpm = 0).
+ *
+ * In the simulator there is no fan on the pin, so under TACH_SIM (make
+ * TACHSIM=1) tach_simTick() runs a small motor model from the motor enable
+ * output and feeds the same capture path with synthetic edges. tachSimLoad
+ * (percent of free-running speed) can be changed from gdb to load the fan.
+ * Never build it for hardware: the edges add to the real ones.
+ */
+
+#define TACH_PULSES 2        // tach pulses per revolution
+#define TACH_AVG 4           // periods averaged, power of two
+#define TACH_STALL_MS 500    // no edge for this long: stopped
+
+extern volatile unsigned short tachRpm;
+extern volatile unsigned long tachPeriod; // averaged edge period, 8 us counts
+
+void tach_init(void);
+
+/*
+ * Record one tach edge (timestamp from ticks_now / ticks_at)
+ */
+void tach_capture(unsigned long stamp);
+
+/*
+ * Update tachRpm, call every 100 ms
+ */
+void tach_Tick(void);
+
+#ifdef TACH_SIM
+#define TACH_SIM_MAX_RPM 3000 // free-running speed at 100% duty
+extern unsigned char tachSimLoad;
+void tach_simTick(unsigned char motorEnable); // call every 1 ms
+#endif
+
+#endif
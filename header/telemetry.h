@@ -0,0 +1,38 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+/*
+ * Telemetry frame (type TELEMETRY_FRAME, sent with uart_sendFrame)
+ * Little-endian, decoded by tools/telemetry.py -- keep the two in sync.
+ */
+
+#define TELEMETRY_FRAME 0x01
+#define TELEMETRY_PERIOD_MS 100 // default rate, telemetryPeriod = 0 stops it
+
+typedef struct {
+    unsigned short ms;        // TimerTicks, low 16 bits
+    unsigned char states[4];  // zone 0's M_Tick state, osc_state, d2_state, H_state
+    unsigned char flags;      // TELEMETRY_* bits
+    unsigned char speed;      // zone 0's preset (zone.h)
+    unsigned char duty;       // motor PWM duty, percent
+    unsigned char servo;      // servo pulse width being generated, ms (0: none)
+    unsigned char temp;       // zone 0's temp
+    unsigned char threshold;  // zone 0's threshold
+    unsigned short rpm;       // tachRpm
+    unsigned short loopMax;   // longest loop iteration since the last frame, 8 us counts
+    unsigned char overruns;   // loop iterations that missed their 1 ms tick since the last frame
+    unsigned char evqDropped; // inputQueue.dropped
+    unsigned char uartDropped;
+    unsigned short stackFree;
+    unsigned char fgMax;      // longest foreground tier run (fg_Tick) since the last frame, 8 us counts, 0xFF: over 1 ms
+    unsigned char fgSkipped;  // ticks that skipped fg_Tick (still running) since the last frame, saturating
+} telemetry_t;
+
+#define TELEMETRY_FAN     0x01
+#define TELEMETRY_OSC     0x02
+#define TELEMETRY_TEMP    0x04
+#define TELEMETRY_HOLD    0x08
+#define TELEMETRY_STALL   0x10
+#define TELEMETRY_MOTOR   0x20 // zone 0's motor output at the time of the frame
+
+#endif
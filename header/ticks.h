@@ -0,0 +1,45 @@
+#ifndef __TICKS_H__
+#define __TICKS_H__
+
+#include <avr/io.h>
+
+/*
+ * Fine-grained timestamps from Timer1 (see timer.h)
+ * Timer1 runs in CTC mode at 8 MHz / 64 with OCR1A = 124: it counts
+ * 0..124, so one count is 8 us, one period is 125 counts (exactly 1 ms)
+ * and TimerTicks counts the compare matches.
+ */
+
+#define TICKS_PER_MS 125 // Timer1 counts per TimerTicks increment
+#define TICKS_US 8       // microseconds per Timer1 count
+
+extern volatile unsigned long TimerTicks;
+
+/*
+ * Timestamp of a Timer1 count read in the current millisecond (TCNT1 or a
+ * captured ICR1). Interrupts must be off, e.g. inside an ISR. A compare
+ * match that is pending but not yet serviced is accounted for, so the
+ * result never steps backwards.
+ */
+static inline unsigned long ticks_at(unsigned short count) {
+    unsigned long ms = TimerTicks;
+    if ((TIFR1 & (1 << OCF1A)) && count < TICKS_PER_MS / 2)
+        ms++;
+    return ms * TICKS_PER_MS + count;
+}
+
+/*
+ * Current time in Timer1 counts (8 us)
+ * Safe from both tasks and ISRs.
+ */
+static inline unsigned long ticks_now(void) {
+    unsigned char sreg = SREG;
+    unsigned long now;
+
+    __asm__ __volatile__ ("cli" ::: "memory");
+    now = ticks_at(TCNT1);
+    SREG = sreg;
+    return now;
+}
+
+#endif
@@ -4,7 +4,20 @@
 #include simAVRHeader.h
 #endif
 
+#ifdef REPLAY
+#include "replay.h"
+#endif
+
 volatile unsigned char TimerFlag = 0;
+volatile unsigned long TimerTicks = 0; // Timer1 compare matches (ms) since TimerOn
+
+// Foreground tier, run in the compare ISR every tick (main.c). It runs
+// with interrupts enabled, so the 1-Wire slots, the USART and the tach
+// capture don't wait for it; a tick that finds it still running skips it
+// and counts that in fgSkipped. Keep it short and bounded anyway.
+void fg_Tick(void);
+volatile unsigned char fgRunning = 0; // fg_Tick in progress, interrupts on
+volatile unsigned char fgSkipped = 0; // ticks that skipped fg_Tick, saturating
 
 unsigned long _avr_timer_M = 1;
 unsigned long _avr_timer_cntcurr = 0;
@@ -12,7 +25,7 @@ unsigned long _avr_timer_cntcurr = 0;
 
 void TimerOn() {
     TCCR1B = 0x0B;
-    OCR1A = 125;
+    OCR1A = 124; // CTC counts 0..OCR1A: 125 counts of 8 us, exactly 1 ms
     TIMSK1 = 0x02;
     TCNT1 = 0; 
     _avr_timer_cntcurr = _avr_timer_M;
@@ -29,11 +42,24 @@ void TimerISR() {
 }
 
 ISR(TIMER1_COMPA_vect) {
+    TimerTicks++;
+#ifdef REPLAY
+    replay_Tick();
+#endif
     _avr_timer_cntcurr--;
     if (_avr_timer_cntcurr == 0) {
         TimerISR();
         _avr_timer_cntcurr = _avr_timer_M;
     }
+    if (!fgRunning) {
+        fgRunning = 1;
+        sei();
+        fg_Tick();
+        cli();
+        fgRunning = 0;
+    } else if (fgSkipped < 0xFF) {
+        fgSkipped++;
+    }
 }
 
 void TimerSet(unsigned long M) {
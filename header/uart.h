@@ -0,0 +1,76 @@
+#ifndef __UART_H__
+#define __UART_H__
+
+/*
+ * Interrupt-driven USART0 (TXD0 PD1, RXD0 PD0)
+ *
+ * Bytes are queued in a ring buffer and sent by the UDRE interrupt, so the
+ * caller never waits on the line. The ring is single-producer (tasks) /
+ * single-consumer (ISR) like evq.h. When there isn't room the data is
+ * dropped and counted instead of blocking.
+ *
+ * Frames: 0xA5 0x5A len type payload[len] crc8
+ * crc8 (CRC-8/CCITT, as in settings.c) covers len, type and payload.
+ *
+ * Received frames are reassembled byte by byte in the RX complete interrupt
+ * and handed to tasks through a ring of UART_RX_FRAMES frame slots (the ISR
+ * produces, uart_recvFrame() consumes). Frames with a bad CRC, or longer
+ * than UART_RX_MAX, are discarded and counted in uartRxErrors; complete
+ * frames that find the ring full are counted in uartDropped.
+ *
+ * On a bus node (bus.h) the RS-485 driver is switched on with the first
+ * byte queued and off by the TX complete interrupt once the ring is empty.
+ */
+
+#define UART_BAUD 38400
+#define UART_TX_SIZE 128 // power of two
+
+#define UART_SYNC1 0xA5
+#define UART_SYNC2 0x5A
+#define UART_FRAME_OVERHEAD 5 // sync x2, len, type, crc
+
+#define UART_RX_FRAMES 4 // power of two
+#define UART_RX_MAX 32   // longest payload accepted
+
+typedef struct {
+    unsigned char type;
+    unsigned char len;
+    unsigned char payload[UART_RX_MAX];
+} uart_frame_t;
+
+extern volatile unsigned char uartDropped;  // bytes or frames that didn't fit
+extern volatile unsigned char uartRxErrors; // bad CRC, oversized, framing or overrun
+
+void uart_init(void);
+
+/*
+ * Queue one byte. Returns 0 (and counts a drop) when the ring is full.
+ */
+unsigned char uart_putc(unsigned char c);
+
+/*
+ * Queue a whole frame or nothing. Returns 0 when there isn't room.
+ */
+unsigned char uart_sendFrame(unsigned char type, const void *payload, unsigned char len);
+
+/*
+ * Bytes that can still be queued
+ */
+unsigned char uart_txFree(void);
+
+/*
+ * 1 once everything queued has left the shift register
+ */
+unsigned char uart_idle(void);
+
+/*
+ * Take the oldest received frame. Returns 0 when there is none.
+ */
+unsigned char uart_recvFrame(uart_frame_t *f);
+
+/*
+ * 1 while a frame is being received or waiting for uart_recvFrame()
+ */
+unsigned char uart_rxBusy(void);
+
+#endif
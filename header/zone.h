@@ -0,0 +1,68 @@
+#ifndef __ZONE_H__
+#define __ZONE_H__
+
+/*
+ * Fan zones (make ZONES=n, 1 by default)
+ *
+ * One MCU runs up to four fans. Each zone has its own switch, speed preset,
+ * temperature mode, threshold and thermistor; main.c keeps them in zones[]
+ * and runs the same tasks over every entry. Each zone has its own PWM
+ * channel:
+ *
+ *     zone  PWM                                  sensor
+ *     0     PD3, on the Timer1 tick (M_Tick)     ADC7 PA7
+ *     1     Timer0 OC0B, PB4                     ADC6 PA6
+ *     2     Timer2 OC2A, PD7                     ADC5 PA5
+ *     3     Timer3 compare interrupts, PC0       ADC4 PA4
+ *
+ * Zones 1-3 are driven at 8 MHz / 64 / 256 = 488 Hz with the duty zone 0's
+ * preset would have, one direction only (low-side switch). OC3A is PB6,
+ * which the Nokia SPI master holds as MISO, so Timer3 sets and clears PC0
+ * from its overflow and compare interrupts instead.
+ *
+ * The pins come from the HD44780 (RS PB4, E PD7, data on PORTC) and the
+ * status LEDs (PA5, PA6), so multi-zone boards have neither, and a fourth
+ * zone takes the IR receiver's PA4 as well. The Nokia status display shows
+ * one zone at a time; the Osc button pages through them (oscillation is
+ * then on the remote and CMD_OSC). The tach, speed hold and oscillator stay
+ * with zone 0, as do settings, telemetry and the history log.
+ */
+
+#ifndef ZONES
+#define ZONES 1
+#endif
+
+#if ZONES < 1 || ZONES > 4
+#error "ZONES must be 1 to 4"
+#endif
+#if ZONES > 1 && defined(TEMP_ONEWIRE)
+#error "zones read their own thermistors, build multi-zone units without TEMP_ONEWIRE"
+#endif
+
+#define ZONE_CHANNEL(z) (7 - (z)) // ADC channel of a zone's thermistor
+
+typedef struct {
+    unsigned char on;        // fan switched on
+    unsigned char speed;     // preset, index into speeds[]
+    unsigned char tempMode;  // on/off follows temp > threshold
+    unsigned char threshold;
+    unsigned char temp;      // last reading, ADC units
+    unsigned char stall;     // zone 0: latched by the speed hold loop
+    unsigned char state;     // M_Tick state
+    unsigned char motor;     // zone 0: PWM counter
+    unsigned char enable;    // PWM output on (zone 0: this tick)
+    unsigned char pwm;       // zones 1-3: compare value last set
+} zone_t;
+
+/*
+ * Start the timers of zones 1 .. ZONES - 1, outputs off
+ */
+void zone_init(void);
+
+/*
+ * Set a zone's (1 .. ZONES - 1) compare value, high for duty/256 of each
+ * period; 0 switches the output off
+ */
+void zone_pwm(unsigned char z, unsigned char duty);
+
+#endif
@@ -0,0 +1,144 @@
+#include <avr/io.h>
+#include "bus.h"
+#include "command.h"
+#include "pins.h"
+
+#ifdef BUS_NODE
+
+void bus_init(void) {
+    PIN_LOW(BUS_DE_PIN);
+    PIN_OUTPUT(BUS_DE_PIN);
+}
+
+#if BUS_NODE == BUS_MASTER
+
+static void bus_send(unsigned char type, unsigned char dst, unsigned char seq,
+        const unsigned char *ops, unsigned char len) {
+    unsigned char p[BUS_HEADER + 4];
+    unsigned char i;
+
+    p[0] = dst;
+    p[1] = BUS_NODE;
+    p[2] = seq;
+    for(i = 0; i < len; i++)
+        p[BUS_HEADER + i] = ops[i];
+    uart_sendFrame(type, p, BUS_HEADER + len); // sent only once uart_idle()
+}
+
+bus_group_t busGroup;
+bus_node_t busNodes[BUS_NODES];
+
+enum bus_States {bus_idle, bus_wait};
+static unsigned char state = bus_idle;
+static unsigned char node = 0;     // node of the frame in flight
+static unsigned char seq = 0;
+static unsigned char waited = 0;   // ms since it was queued
+static unsigned short sinceSync = BUS_SYNC_MS; // first broadcast right away
+static unsigned short sinceStart = 0; // ms since the last motor start
+static unsigned char wasOn = 0;
+static unsigned char syncedSpeed = 0xFF;
+
+// Answers that come too late for their frame are dropped
+static void bus_collect(void) {
+    uart_frame_t f;
+    const bus_status_t *s = (const bus_status_t *)f.payload;
+    bus_node_t *n;
+
+    while(uart_recvFrame(&f)) {
+        if(f.type != BUS_STATUS || f.len != sizeof(bus_status_t) || s->dst != BUS_MASTER)
+            continue;
+        if(state != bus_wait || s->src != node || s->seq != seq)
+            continue;
+        n = &busNodes[node];
+        n->alive = 1;
+        n->on = s->on;
+        n->speed = s->speed;
+        n->tempMode = s->tempMode;
+        n->temp = s->temp;
+        n->rpm = s->rpm;
+        state = bus_idle;
+    }
+}
+
+void bus_Tick(void) {
+    unsigned char ops[4];
+    bus_node_t *n;
+
+    bus_collect();
+    if(sinceSync < BUS_SYNC_MS)
+        sinceSync++;
+    if(sinceStart < BUS_STAGGER_MS)
+        sinceStart++;
+    if(busGroup.on && !wasOn)
+        sinceStart = 0; // the master's own motor just started
+    wasOn = busGroup.on;
+
+    if(state == bus_wait) {
+        if(++waited < BUS_REPLY_MS)
+            return;
+        n = &busNodes[node];
+        n->alive = 0;
+        if(n->timeouts < 0xFF)
+            n->timeouts++;
+        state = bus_idle;
+    }
+    if(!uart_idle()) // a broadcast still going out
+        return;
+
+    if(sinceSync >= BUS_SYNC_MS || busGroup.speed != syncedSpeed) {
+        ops[0] = CMD_SPEED;
+        ops[1] = busGroup.speed;
+        ops[2] = CMD_TEMP;
+        ops[3] = busGroup.temp;
+        bus_send(BUS_CMD, BUS_BROADCAST, ++seq, ops, 4);
+        syncedSpeed = busGroup.speed;
+        sinceSync = 0;
+        return;
+    }
+
+    node = (node + 1 < BUS_NODES) ? node + 1 : 1;
+    n = &busNodes[node];
+    if(n->alive && !n->tempMode && n->on != busGroup.on
+            && (!busGroup.on || sinceStart >= BUS_STAGGER_MS)) {
+        ops[0] = CMD_POWER;
+        ops[1] = busGroup.on;
+        bus_send(BUS_CMD, node, ++seq, ops, 2);
+        if(busGroup.on)
+            sinceStart = 0;
+    } else {
+        bus_send(BUS_POLL, node, ++seq, ops, 0);
+    }
+    state = bus_wait;
+    waited = 0;
+}
+
+#else
+
+unsigned char bus_recv(bus_request_t *r) {
+    uart_frame_t f;
+    unsigned char i;
+
+    while(uart_recvFrame(&f)) {
+        if((f.type != BUS_POLL && f.type != BUS_CMD) || f.len < BUS_HEADER)
+            continue;
+        if(f.payload[1] != BUS_MASTER || (f.payload[0] != BUS_NODE && f.payload[0] != BUS_BROADCAST))
+            continue; // another node's, or an answer
+        r->seq = f.payload[2];
+        r->reply = f.payload[0] == BUS_NODE;
+        r->len = (f.type == BUS_CMD) ? f.len - BUS_HEADER : 0;
+        for(i = 0; i < r->len; i++)
+            r->ops[i] = f.payload[BUS_HEADER + i];
+        return 1;
+    }
+    return 0;
+}
+
+void bus_reply(bus_status_t *s) {
+    s->dst = BUS_MASTER;
+    s->src = BUS_NODE;
+    uart_sendFrame(BUS_STATUS, s, sizeof(bus_status_t));
+}
+
+#endif
+
+#endif
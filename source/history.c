@@ -0,0 +1,519 @@
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include <string.h>
+#include "history.h"
+#include "uart.h"
+
+#define NONE 0xFFFF
+
+// Tag bits (history.h)
+#define KEY       0x80
+#define REP_SHIFT 4
+#define REP_MASK  0x70
+#define LOW_MASK  0x0F
+
+unsigned char historyPeriod = HISTORY_PERIOD_S;
+
+static unsigned char hist[HISTORY_SIZE];
+
+// Appends to a log: the SRAM log itself, or the scratch a block is
+// downsampled into
+typedef struct {
+    unsigned char *buf;
+    unsigned short pos;     // bytes used
+    unsigned short size;
+    unsigned short lastTag; // tag of the entry repeats are added to, NONE
+    history_sample_t prev;  // values of the last sample written
+} history_writer_t;
+
+static history_writer_t logw = {hist, 0, HISTORY_SIZE, NONE, {0, 0, 0, 0}};
+static unsigned short openBlock = NONE;     // keyframe of the block being appended to
+static unsigned long openInterval = 0;      // its interval, s
+static unsigned char keyFlags = HISTORY_KEY_BOOT; // for the next keyframe
+static unsigned char generation = 0;        // bumped whenever logged bytes move
+static unsigned char dirty = 0;             // changed since the last checkpoint
+
+static unsigned long now = 0;               // s since reset
+static unsigned char sinceSample = 0;
+static unsigned short sinceCheckpoint = 0;  // s
+
+static unsigned char scratch[HISTORY_BLOCK + 16]; // one downsampled block
+
+// One decoded entry
+typedef struct {
+    history_sample_t v;     // its first sample; deltas apply to the previous entry's
+    unsigned char rep;      // further identical samples
+    unsigned char key;      // KEY | HISTORY_KEY_* for a keyframe, else 0
+    unsigned long interval; // keyframe only
+    unsigned long stamp;    // keyframe only
+} history_entry_t;
+
+/*
+ * Encoding
+ */
+
+static unsigned char history_putVarint(unsigned char *p, unsigned long v) {
+    unsigned char n = 0;
+
+    while(v >= 0x80) {
+        p[n++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    p[n++] = v;
+    return n;
+}
+
+// Difference of two 8-bit values, small either way round -> small
+static unsigned char history_zigzag(unsigned char from, unsigned char to) {
+    signed char d = (signed char)(to - from);
+    return (unsigned char)((d << 1) ^ (d >> 7));
+}
+
+static unsigned char history_unzigzag(unsigned char z) {
+    return (z >> 1) ^ (unsigned char)-(z & 1);
+}
+
+static unsigned char history_emitKey(history_writer_t *w, const history_sample_t *s,
+        unsigned char flags, unsigned long interval, unsigned long stamp) {
+    unsigned char tmp[16];
+    unsigned char n = 0;
+
+    tmp[n++] = KEY | flags;
+    n += history_putVarint(tmp + n, interval);
+    tmp[n++] = stamp;
+    tmp[n++] = stamp >> 8;
+    tmp[n++] = stamp >> 16;
+    tmp[n++] = s->temp;
+    tmp[n++] = s->duty;
+    tmp[n++] = s->flags;
+    tmp[n++] = s->overruns;
+    if(w->pos + n > w->size)
+        return 0;
+    memcpy(w->buf + w->pos, tmp, n);
+    w->lastTag = w->pos;
+    w->pos += n;
+    w->prev = *s;
+    return 1;
+}
+
+static unsigned char history_emit(history_writer_t *w, const history_sample_t *s) {
+    unsigned char tmp[8];
+    unsigned char n = 1;
+    unsigned char mask = 0;
+
+    if(s->temp != w->prev.temp) {
+        mask |= HISTORY_TEMP;
+        n += history_putVarint(tmp + n, history_zigzag(w->prev.temp, s->temp));
+    }
+    if(s->duty != w->prev.duty) {
+        mask |= HISTORY_DUTY;
+        n += history_putVarint(tmp + n, history_zigzag(w->prev.duty, s->duty));
+    }
+    if(s->flags != w->prev.flags) {
+        mask |= HISTORY_FLAGS;
+        tmp[n++] = s->flags;
+    }
+    if(s->overruns) {
+        mask |= HISTORY_OVERRUNS;
+        n += history_putVarint(tmp + n, s->overruns);
+    }
+    if(mask == 0 && w->lastTag != NONE && (w->buf[w->lastTag] & REP_MASK) != REP_MASK) {
+        w->buf[w->lastTag] += 1 << REP_SHIFT; // one more of the same
+        return 1;
+    }
+    tmp[0] = mask;
+    if(w->pos + n > w->size)
+        return 0;
+    memcpy(w->buf + w->pos, tmp, n);
+    w->lastTag = w->pos;
+    w->pos += n;
+    w->prev = *s;
+    return 1;
+}
+
+/*
+ * Decoding (bounded by HISTORY_SIZE, a restored log is parsed before use)
+ */
+
+static unsigned char history_byte(unsigned short pos) {
+    return pos < HISTORY_SIZE ? hist[pos] : 0;
+}
+
+static unsigned short history_getVarint(unsigned short pos, unsigned long *v) {
+    unsigned char shift = 0;
+    unsigned char b;
+
+    *v = 0;
+    do {
+        b = history_byte(pos++);
+        *v |= (unsigned long)(b & 0x7F) << shift;
+        shift += 7;
+    } while((b & 0x80) && shift < 28);
+    return pos;
+}
+
+// Decode the entry at pos into e (e->v holds the previous entry's values).
+// Returns the position of the next entry.
+static unsigned short history_parse(unsigned short pos, history_entry_t *e) {
+    unsigned char tag = history_byte(pos++);
+    unsigned long v;
+
+    e->rep = (tag & REP_MASK) >> REP_SHIFT;
+    if(tag & KEY) {
+        e->key = KEY | (tag & LOW_MASK);
+        pos = history_getVarint(pos, &e->interval);
+        e->stamp = history_byte(pos) | ((unsigned long)history_byte(pos + 1) << 8)
+            | ((unsigned long)history_byte(pos + 2) << 16);
+        pos += 3;
+        e->v.temp = history_byte(pos++);
+        e->v.duty = history_byte(pos++);
+        e->v.flags = history_byte(pos++);
+        e->v.overruns = history_byte(pos++);
+        return pos;
+    }
+    e->key = 0;
+    if(tag & HISTORY_TEMP) {
+        pos = history_getVarint(pos, &v);
+        e->v.temp += history_unzigzag(v);
+    }
+    if(tag & HISTORY_DUTY) {
+        pos = history_getVarint(pos, &v);
+        e->v.duty += history_unzigzag(v);
+    }
+    if(tag & HISTORY_FLAGS)
+        e->v.flags = history_byte(pos++);
+    e->v.overruns = 0;
+    if(tag & HISTORY_OVERRUNS) {
+        pos = history_getVarint(pos, &v);
+        e->v.overruns = v > 0xFF ? 0xFF : v;
+    }
+    return pos;
+}
+
+// End of the block whose keyframe is at pos
+static unsigned short history_blockEnd(unsigned short pos) {
+    history_entry_t e;
+
+    memset(&e, 0, sizeof(e));
+    pos = history_parse(pos, &e);
+    while(pos < logw.pos && !(hist[pos] & KEY))
+        pos = history_parse(pos, &e);
+    return pos;
+}
+
+/*
+ * Downsampling
+ */
+
+static unsigned char history_merge(history_writer_t *w, const history_entry_t *key,
+        const history_sample_t *s) {
+    if(w->pos == 0)
+        return history_emitKey(w, s, key->key & LOW_MASK, key->interval * 2, key->stamp);
+    return history_emit(w, s);
+}
+
+// Re-encode the block [pos, end) into scratch at half the resolution.
+// Returns its new length, 0 when it can't get any coarser.
+static unsigned char history_downsample(unsigned short pos, unsigned short end) {
+    history_writer_t w = {scratch, 0, sizeof(scratch), NONE, {0, 0, 0, 0}};
+    history_entry_t key, e;
+    history_sample_t pending, s;
+    unsigned char held = 0;
+    unsigned char i;
+
+    memset(&e, 0, sizeof(e));
+    pos = history_parse(pos, &e);
+    key = e;
+    if(!(key.key & KEY) || key.interval * 2 > HISTORY_MAX_INTERVAL)
+        return 0;
+    for(;;) {
+        for(i = 0; i <= e.rep; i++) {
+            s = e.v;
+            if(i)
+                s.overruns = 0;
+            if(!held) {
+                pending = s;
+                held = 1;
+                continue;
+            }
+            // pairs become one sample: the first one's values, both overruns
+            pending.overruns = (pending.overruns + s.overruns > 0xFF) ? 0xFF
+                : pending.overruns + s.overruns;
+            if(!history_merge(&w, &key, &pending))
+                return 0;
+            held = 0;
+        }
+        if(pos >= end)
+            break;
+        pos = history_parse(pos, &e);
+    }
+    if(held && !history_merge(&w, &key, &pending))
+        return 0;
+    return w.pos;
+}
+
+// Make room: downsample the blocks in the older half of the log, or drop
+// the oldest block when none of them gets smaller. Returns 0 when nothing
+// could be freed.
+static unsigned char history_compact(void) {
+    unsigned short r = 0;
+    unsigned short w = 0;
+    unsigned short end, shift;
+    unsigned char n;
+    unsigned char progress = 0;
+
+    while(r < HISTORY_SIZE / 2 && r < logw.pos && r != openBlock) {
+        end = history_blockEnd(r);
+        n = history_downsample(r, end);
+        if(n && n < end - r) {
+            memcpy(hist + w, scratch, n);
+            w += n;
+            progress = 1;
+        } else {
+            memmove(hist + w, hist + r, end - r);
+            w += end - r;
+        }
+        r = end;
+    }
+    if(!progress && logw.pos) {
+        r = history_blockEnd(0);
+        w = 0;
+    }
+    shift = r - w;
+    memmove(hist + w, hist + r, logw.pos - r);
+    logw.pos -= shift;
+    if(openBlock != NONE && openBlock < r) {
+        openBlock = NONE; // dropped
+        logw.lastTag = NONE;
+    } else if(openBlock != NONE) {
+        openBlock -= shift;
+        logw.lastTag -= shift;
+    }
+    generation++;
+    return shift != 0;
+}
+
+/*
+ * Sampling
+ */
+
+unsigned char history_second(void) {
+    now++;
+    if(HISTORY_CHECKPOINT_MIN && ++sinceCheckpoint >= HISTORY_CHECKPOINT_MIN * 60U) {
+        sinceCheckpoint = 0;
+        if(dirty)
+            history_checkpoint();
+    }
+    if(historyPeriod == 0 || ++sinceSample < historyPeriod)
+        return 0;
+    sinceSample = 0;
+    return 1;
+}
+
+void history_add(const history_sample_t *s) {
+    unsigned short at;
+
+    dirty = 1;
+    for(;;) {
+        if(openBlock == NONE || openInterval != historyPeriod
+                || logw.pos - openBlock >= HISTORY_BLOCK) {
+            at = logw.pos;
+            if(history_emitKey(&logw, s, keyFlags, historyPeriod, now)) {
+                openBlock = at;
+                openInterval = historyPeriod;
+                keyFlags = 0;
+                return;
+            }
+        } else if(history_emit(&logw, s)) {
+            return;
+        }
+        if(!history_compact()) {
+            history_clear(); // can't happen with HISTORY_BLOCK < HISTORY_SIZE / 2
+            return;
+        }
+    }
+}
+
+void history_wake(void) {
+    openBlock = NONE;
+    logw.lastTag = NONE;
+    keyFlags |= HISTORY_KEY_WAKE;
+}
+
+void history_clear(void) {
+    logw.pos = 0;
+    logw.lastTag = NONE;
+    openBlock = NONE;
+    generation++;
+    dirty = 1;
+}
+
+/*
+ * Dump
+ */
+
+static unsigned short dumpPos = NONE; // next byte to send, NONE idle
+static unsigned short dumpLen = 0;
+static unsigned char dumpGen = 0;
+static unsigned char dumpInfo = 0;    // HISTORY_INFO still to send
+
+void history_dump(void) {
+    dumpPos = 0;
+    dumpInfo = 1;
+}
+
+static void history_dumpTick(void) {
+    unsigned char buf[HISTORY_CHUNK + 2];
+    unsigned char n;
+
+    if(dumpPos == NONE)
+        return;
+    if(!dumpInfo && dumpGen != generation) {
+        dumpPos = 0; // compacted under us, start over
+        dumpInfo = 1;
+    }
+    // half the ring left to telemetry and acks
+    if(uart_txFree() < UART_TX_SIZE / 2)
+        return;
+    if(dumpInfo) {
+        buf[0] = logw.pos;
+        buf[1] = logw.pos >> 8;
+        buf[2] = now;
+        buf[3] = now >> 8;
+        buf[4] = now >> 16;
+        buf[5] = historyPeriod;
+        if(uart_sendFrame(HISTORY_INFO, buf, 6)) {
+            dumpInfo = 0;
+            dumpLen = logw.pos;
+            dumpGen = generation;
+        }
+        return;
+    }
+    if(dumpPos >= dumpLen) {
+        dumpPos = NONE;
+        return;
+    }
+    n = (dumpLen - dumpPos < HISTORY_CHUNK) ? dumpLen - dumpPos : HISTORY_CHUNK;
+    buf[0] = dumpPos;
+    buf[1] = dumpPos >> 8;
+    memcpy(buf + 2, hist + dumpPos, n);
+    if(uart_sendFrame(HISTORY_DATA, buf, n + 2))
+        dumpPos += n;
+}
+
+/*
+ * EEPROM checkpoint
+ */
+
+typedef struct {
+    unsigned char seq;    // newer slot has the higher seq (mod 256)
+    unsigned char len[2]; // little-endian
+    unsigned char crc;    // CRC-8 of data[0 .. len), then seq and len
+    unsigned char data[HISTORY_SIZE];
+} history_slot_t;
+
+static history_slot_t slots[2] EEMEM;
+
+static unsigned char ckSeq = 0;       // seq of the newest good slot
+static unsigned char ckSlot = 0;      // slot written next
+static unsigned short ckPos = NONE;   // next byte, NONE idle
+static unsigned short ckLen = 0;
+static unsigned char ckGen = 0;
+static unsigned char ckCrc = 0;
+
+void history_checkpoint(void) {
+    ckPos = 0;
+    ckLen = logw.pos;
+    ckGen = generation;
+    ckCrc = 0;
+    dirty = 0;
+}
+
+static void history_checkpointTick(void) {
+    unsigned char header[4];
+    unsigned char b;
+
+    if(ckPos == NONE || !eeprom_is_ready())
+        return;
+    if(ckGen != generation) {
+        history_checkpoint(); // bytes moved, start over
+        dirty = 1;
+    }
+    if(ckPos < ckLen) {
+        // a repeat count may still change after it's written; the CRC
+        // covers the value written, which is a valid log either way
+        b = hist[ckPos];
+        eeprom_update_byte(&slots[ckSlot].data[ckPos], b);
+        ckCrc = _crc8_ccitt_update(ckCrc, b);
+        ckPos++;
+        return;
+    }
+    // header last: a copy cut short fails its CRC and the other slot is used
+    header[0] = ckSeq + 1;
+    header[1] = ckLen;
+    header[2] = ckLen >> 8;
+    header[3] = _crc8_ccitt_update(_crc8_ccitt_update(_crc8_ccitt_update(ckCrc,
+        header[0]), header[1]), header[2]);
+    b = ckPos - ckLen;
+    eeprom_update_byte((unsigned char *)&slots[ckSlot] + b, header[b]);
+    if(++ckPos - ckLen == sizeof(header)) {
+        ckSeq++;
+        ckSlot ^= 1;
+        ckPos = NONE;
+    }
+}
+
+void history_Tick(void) {
+    history_dumpTick();
+    history_checkpointTick();
+}
+
+unsigned char history_busy(void) {
+    return dumpPos != NONE || ckPos != NONE;
+}
+
+// CRC of a slot as stored, 0xFFFF when its length is out of range
+static unsigned short history_slotCrc(unsigned char i, unsigned char *seq, unsigned short *len) {
+    unsigned char crc = 0;
+    unsigned short pos;
+
+    *seq = eeprom_read_byte(&slots[i].seq);
+    *len = eeprom_read_byte(&slots[i].len[0]) | (eeprom_read_byte(&slots[i].len[1]) << 8);
+    if(*len > HISTORY_SIZE)
+        return NONE;
+    for(pos = 0; pos < *len; pos++)
+        crc = _crc8_ccitt_update(crc, eeprom_read_byte(&slots[i].data[pos]));
+    crc = _crc8_ccitt_update(crc, *seq);
+    crc = _crc8_ccitt_update(crc, *len);
+    crc = _crc8_ccitt_update(crc, *len >> 8);
+    return crc;
+}
+
+void history_init(void) {
+    unsigned char seq[2];
+    unsigned short len[2];
+    unsigned char good[2];
+    unsigned char i, newest;
+    unsigned short pos;
+    history_entry_t e;
+
+    for(i = 0; i < 2; i++)
+        good[i] = history_slotCrc(i, &seq[i], &len[i]) == eeprom_read_byte(&slots[i].crc);
+    if(!good[0] && !good[1])
+        return;
+    newest = (good[0] && good[1]) ? ((signed char)(seq[1] - seq[0]) > 0)
+        : good[1];
+    eeprom_read_block(hist, slots[newest].data, len[newest]);
+
+    // must parse to exactly its length, starting with a keyframe
+    pos = 0;
+    memset(&e, 0, sizeof(e));
+    while(pos < len[newest] && (pos || (hist[0] & KEY)))
+        pos = history_parse(pos, &e);
+    if(pos != len[newest])
+        return;
+    logw.pos = len[newest];
+    ckSeq = seq[newest];
+    ckSlot = newest ^ 1;
+}
@@ -0,0 +1,87 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "input.h"
+#include "power.h"
+#include "ticks.h"
+#include "IR.h"
+
+evq_t inputQueue;
+
+static unsigned char buttons = 0x00;       // debounced pressed mask
+static unsigned long buttonChange = 0;     // ticks_now() of the last button edge
+static unsigned char irLevel = INPUT_IR;   // receiver idles high
+
+// NEC frame decoder, falling edge to falling edge (8 us counts)
+#define NEC_START_MIN 1560 // 12.5 ms (9 ms mark + 4.5 ms space = 13.5 ms)
+#define NEC_START_MAX 1810 // 14.5 ms
+#define NEC_ZERO_MIN  110  // 0.9 ms  (1.125 ms)
+#define NEC_ZERO_MAX  175  // 1.4 ms
+#define NEC_ONE_MIN   250  // 2.0 ms  (2.25 ms)
+#define NEC_ONE_MAX   315  // 2.5 ms
+static unsigned long irEdge = 0;
+static unsigned long irCode = 0;
+static unsigned char irBits = 0xFF; // 0xFF: waiting for a start burst
+
+void input_init(void) {
+    buttons = ~PINA & INPUT_BUTTONS;
+    irLevel = PINA & INPUT_IR;
+    PCMSK0 = INPUT_BUTTONS | INPUT_IR;
+    PCIFR = (1 << PCIF0);
+    PCICR |= (1 << PCIE0);
+}
+
+static void input_ir(unsigned long now) {
+    unsigned long dt = now - irEdge;
+    unsigned char i;
+
+    irEdge = now;
+    if(dt >= NEC_START_MIN && dt <= NEC_START_MAX) {
+        irCode = 0;
+        irBits = 0;
+        return;
+    }
+    if(irBits >= 32)
+        return;
+    if(dt >= NEC_ZERO_MIN && dt <= NEC_ZERO_MAX) {
+        irCode <<= 1;
+    } else if(dt >= NEC_ONE_MIN && dt <= NEC_ONE_MAX) {
+        irCode = (irCode << 1) | 1;
+    } else {
+        irBits = 0xFF; // noise, wait for the next start burst
+        return;
+    }
+    if(++irBits < 32)
+        return;
+
+    // keyValue[] holds the codes MSB first as received, e.g. 0xFFA25D
+    for(i = 0; i < KEY_NUM; i++) {
+        if(pgm_read_dword(&keyValue[i]) == irCode) {
+            evq_push(&inputQueue, EV_IR, i);
+            break;
+        }
+    }
+    irBits = 0xFF;
+}
+
+void input_pins(unsigned char pin, unsigned long now) {
+    unsigned char pressed = ~pin & INPUT_BUTTONS;
+
+    if(pressed != buttons) {
+        // only count a press if the buttons were stable before this edge,
+        // which drops both press and release bounce
+        if((pressed & ~buttons) && now - buttonChange >= INPUT_DEBOUNCE_MS * TICKS_PER_MS)
+            evq_push(&inputQueue, EV_KEY, pressed & ~buttons);
+        buttons = pressed;
+        buttonChange = now;
+    }
+    if((pin & INPUT_IR) != irLevel) {
+        irLevel = pin & INPUT_IR;
+        if(!irLevel) // receiver output is active low
+            input_ir(now);
+    }
+}
+
+ISR(PCINT0_vect) {
+    power_pinWake();
+    input_pins(PINA, ticks_now());
+}
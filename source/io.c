@@ -2,17 +2,18 @@
 #include <avr/interrupt.h>
 #include <stdio.h>
 #include "io.h"
+#include "pins.h"
+#include "pt.h"
+
+#if ZONES == 1 // multi-zone boards have no HD44780 (zone.h)
 
-#define SET_BIT(p,i) ((p) |= (1 << (i)))
-#define CLR_BIT(p,i) ((p) &= ~(1 << (i)))
-#define GET_BIT(p,i) ((p) & (1 << (i)))
-          
 /*-------------------------------------------------------------------------*/
 
 #define DATA_BUS PORTC		// port connected to pins 7-14 of LCD display
-#define CONTROL_BUS PORTD	// port connected to pins 4 and 6 of LCD disp.
-#define RS 6			// pin number of uC connected to pin 4 of LCD disp.
-#define E 7			// pin number of uC connected to pin 6 of LCD disp.
+#define RS_PIN PORTB, 4		// pin 4 of LCD disp.
+#define E_PIN PORTD, 7		// pin 6 of LCD disp.
+				// (RS moved off PD6, which is ICP1 for the tach, and
+				// off PB6, which is MISO for the Nokia SPI)
 
 /*-------------------------------------------------------------------------*/
 
@@ -31,21 +32,96 @@ void LCD_init(void) {
 	delay_ms(10);						 
 }
 
+/*-------------------------------------------------------------------------*/
+/* Non-blocking interface: no delay after the strobe. The caller has to   */
+/* leave one scheduler tick (1 ms) between writes, 2 ms after a clear.    */
+/* The *_Tick operations are protothreads (pt.h) that do exactly that.    */
+
+static void LCD_Strobe(unsigned char rs, unsigned char value) {
+   PIN_SET(RS_PIN, rs);
+   PORT_WRITE(DATA_BUS, value);
+   PIN_HIGH(E_PIN);
+   asm("nop");
+   PIN_LOW(E_PIN);
+}
+
+void LCD_PutCommand(unsigned char Command) {
+   LCD_Strobe(0, Command);
+}
+
+void LCD_PutData(unsigned char Data) {
+   LCD_Strobe(1, Data);
+}
+
+// DDRAM address command for a column as LCD_Cursor numbers them
+static unsigned char LCD_CursorCommand(unsigned char column) {
+   if ( column < 17 ) { // 16x1 LCD: column < 9
+						// 16x2 LCD: column < 17
+      return 0x80 + column - 1;
+   } else {
+      return 0xB8 + column - 9;	// 16x1 LCD: column - 1
+								// 16x2 LCD: column - 9
+   }
+}
+
+static pt_t initPt;
+static unsigned char initWait;
+
+unsigned char LCD_init_Tick(void) {
+   PT_BEGIN(&initPt);
+   PT_DELAY(&initPt, initWait, 100); // power-on wait, 100 ms
+   LCD_PutCommand(0x38);
+   PT_YIELD(&initPt);
+   LCD_PutCommand(0x06);
+   PT_YIELD(&initPt);
+   LCD_PutCommand(0x0f);
+   PT_YIELD(&initPt);
+   LCD_PutCommand(0x01);
+   PT_DELAY(&initPt, initWait, 10);
+   PT_END(&initPt);
+}
+
+static pt_t stringPt;
+static unsigned char stringPos;
+static unsigned char stringWait;
+
+unsigned char LCD_DisplayString_Tick(unsigned char column, const unsigned char *string) {
+   PT_BEGIN(&stringPt);
+   LCD_PutCommand(0x01);
+   PT_DELAY(&stringPt, stringWait, 2);
+   // DDRAM auto-increments, so the cursor is only set at the start of each line
+   for (stringPos = 0; string[stringPos]; stringPos++) {
+      if (stringPos == 0 || column + stringPos == 17) {
+         LCD_PutCommand(LCD_CursorCommand(column + stringPos));
+         PT_YIELD(&stringPt);
+      }
+      LCD_PutData(string[stringPos]);
+      PT_YIELD(&stringPt);
+   }
+   PT_END_RESTART(&stringPt);
+}
+
+/*-------------------------------------------------------------------------*/
+
+void LCD_Display(unsigned char on) {
+   LCD_WriteCommand(on ? 0x0F : 0x08); // display, cursor and blink on / all off
+}
+
 void LCD_WriteCommand (unsigned char Command) {
-   CLR_BIT(CONTROL_BUS,RS);
-   DATA_BUS = Command;
-   SET_BIT(CONTROL_BUS,E);
+   PIN_LOW(RS_PIN);
+   PORT_WRITE(DATA_BUS, Command);
+   PIN_HIGH(E_PIN);
    asm("nop");
-   CLR_BIT(CONTROL_BUS,E);
+   PIN_LOW(E_PIN);
    delay_ms(2); // ClearScreen requires 1.52ms to execute
 }
 
 void LCD_WriteData(unsigned char Data) {
-   SET_BIT(CONTROL_BUS,RS);
-   DATA_BUS = Data;
-   SET_BIT(CONTROL_BUS,E);
+   PIN_HIGH(RS_PIN);
+   PORT_WRITE(DATA_BUS, Data);
+   PIN_HIGH(E_PIN);
    asm("nop");
-   CLR_BIT(CONTROL_BUS,E);
+   PIN_LOW(E_PIN);
    delay_ms(1);
 }
 
@@ -59,13 +135,7 @@ void LCD_DisplayString( unsigned char column, const unsigned char* string) {
 }
 
 void LCD_Cursor(unsigned char column) {
-   if ( column < 17 ) { // 16x1 LCD: column < 9
-						// 16x2 LCD: column < 17
-      LCD_WriteCommand(0x80 + column - 1);
-   } else {
-      LCD_WriteCommand(0xB8 + column - 9);	// 16x1 LCD: column - 1
-											// 16x2 LCD: column - 9
-   }
+   LCD_WriteCommand(LCD_CursorCommand(column));
 }
 
 void delay_ms(int miliSec) //for 8 Mhz crystal
@@ -78,3 +148,5 @@ void delay_ms(int miliSec) //for 8 Mhz crystal
    asm("nop");
   }
 }
+
+#endif
@@ -0,0 +1,92 @@
+#ifdef DISPLAY_LINK
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include "link.h"
+#include "uart.h"
+
+#define LINK_SS PB0
+
+volatile unsigned char linkDropped = 0;
+
+static unsigned char txBuf[LINK_TX_SIZE];
+static volatile unsigned char txHead = 0; // written by tasks
+static volatile unsigned char txTail = 0; // written by the SPI ISR
+static volatile unsigned char txBusy = 0; // a byte is being clocked out
+
+#define link_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+void link_init(void) {
+    DDRB |= (1 << LINK_SS) | (1 << PB4) | (1 << PB5) | (1 << PB7); // PB4 is SS, kept an output
+    PORTB |= (1 << LINK_SS);
+    // master, mode 0, fosc/16: the display MCU's slave needs SCK < fosc/4
+    // and has a byte time (128 cycles) to take each byte
+    SPCR = (1 << SPIE) | (1 << SPE) | (1 << MSTR) | (1 << SPR0);
+}
+
+static unsigned char link_free(void) {
+    return LINK_TX_SIZE - (unsigned char)(txHead - txTail);
+}
+
+// Caller has checked for room
+static void link_queue(unsigned char c) {
+    unsigned char head = txHead;
+    txBuf[head & (LINK_TX_SIZE - 1)] = c;
+    link_barrier();
+    txHead = head + 1;
+}
+
+// Clock out the next byte, or release SS when the ring is empty (ISR or cli)
+static void link_next(void) {
+    unsigned char tail = txTail;
+    if(tail == txHead) {
+        txBusy = 0;
+        PORTB |= (1 << LINK_SS);
+        return;
+    }
+    txBusy = 1;
+    PORTB &= ~(1 << LINK_SS);
+    SPDR = txBuf[tail & (LINK_TX_SIZE - 1)];
+    txTail = tail + 1;
+}
+
+unsigned char link_send(unsigned char type, const void *payload, unsigned char len) {
+    const unsigned char *p = (const unsigned char *)payload;
+    unsigned char crc;
+    unsigned char i;
+    unsigned char sreg;
+
+    if(len > LINK_MAX || link_free() < len + UART_FRAME_OVERHEAD) {
+        linkDropped++;
+        return 0;
+    }
+    link_queue(UART_SYNC1);
+    link_queue(UART_SYNC2);
+    link_queue(len);
+    link_queue(type);
+    crc = _crc8_ccitt_update(0x00, len);
+    crc = _crc8_ccitt_update(crc, type);
+    for(i = 0; i < len; i++) {
+        link_queue(p[i]);
+        crc = _crc8_ccitt_update(crc, p[i]);
+    }
+    link_queue(crc);
+
+    sreg = SREG;
+    cli();
+    if(!txBusy) // otherwise the ISR picks the frame up
+        link_next();
+    SREG = sreg;
+    return 1;
+}
+
+unsigned char link_idle(void) {
+    return !txBusy;
+}
+
+ISR(SPI_STC_vect) {
+    link_next();
+}
+
+#endif
@@ -50,7 +50,23 @@
 #include "timer.h"
 #include "ADC.h"
 #include "nokia5110.h"
-#include "fanbitmaps.h"
+#include "fanframes.h"
+#include "stack.h"
+#include "power.h"
+#include "settings.h"
+#include "ticks.h"
+#include "input.h"
+#include "tach.h"
+#include "uart.h"
+#include "telemetry.h"
+#include "command.h"
+#include "output.h"
+#include "link.h"
+#include "onewire.h"
+#include "history.h"
+#include "zone.h"
+#include "bus.h"
+#include "replay.h"
 
 #ifdef _SIMULATE_
 #include "simAVRHeader.h"
@@ -64,192 +80,310 @@ unsigned char tempD = 0x00;
 #define maxSpeed 4 
 unsigned char speeds[maxSpeed] = {1, 2, 3, 4};
 unsigned char motorSpeeds[maxSpeed] = {11, 20, 40, 100};
-unsigned char pos_speed = 0;
-unsigned char tempThreshold = 0x00;
-unsigned char tempCurrent = 0x00;
 
-unsigned char fanOn = 0x00; // fan status variable
-unsigned char oscillateOn = 0x00; // oscillator status variable
-unsigned char tempMode = 0x00; // temperature mode status variable
+// volatile: shared with the foreground tier (fg_Tick), which runs in the
+// Timer1 ISR
+volatile zone_t zones[ZONES]; // fan zones (zone.h); zone 0 has the tach and the oscillator
+unsigned char zoneShown = 0;  // zone on the status display, the one the buttons work
+volatile unsigned char oscillateOn = 0x00; // oscillator status variable
 
-enum fanStates{F_start, F_wait, F_off, F_on, F_setSpeed, F_tempMode, F_oscillate, F_press} F_state;
+// Switches a fan and updates the "Pwr:" field of the status LCD
+void fan_setPower(volatile zone_t *z, unsigned char on) {
+    z->on = on;
+    LCD_Cursor(5);
+    if(on) {
+        LCD_WriteData('O');
+        LCD_WriteData('n');
+        LCD_WriteData(' ');
+    } else {
+        LCD_WriteData('O');
+        LCD_WriteData('f');
+        LCD_WriteData('f');
+    }
+    LCD_Cursor(0);
+}
+
+// Selects a speed preset; the "Spd:" field shows it unless temperature
+// mode has the field
+void fan_setSpeed(volatile zone_t *z, unsigned char pos) {
+    z->speed = pos;
+    if(z->tempMode == 0x00) {
+        LCD_Cursor(21);
+        LCD_WriteData(speeds[z->speed] + '0');
+        LCD_Cursor(0);
+    }
+}
+
+void fan_nextSpeed(volatile zone_t *z) {
+    if(z->tempMode == 0x00) {
+        if(z->speed + 1 == maxSpeed)
+            fan_setSpeed(z, 0);
+        else
+            fan_setSpeed(z, z->speed + 1);
+    }
+}
+
+void fan_toggleTempMode(volatile zone_t *z) {
+    if(z->tempMode == 0x00) {
+        z->tempMode = 0x01;
+        LCD_Cursor(21);
+        LCD_WriteData('T');
+        LCD_WriteData('e');
+        LCD_WriteData('m');
+        LCD_WriteData('p');
+        LCD_Cursor(0);
+    } else {
+        z->tempMode = 0x00;
+        LCD_Cursor(21);
+        LCD_WriteData(' ');
+        LCD_WriteData(' ');
+        LCD_WriteData(' ');
+        LCD_WriteData(' ');
+
+        LCD_Cursor(21);
+        LCD_WriteData(speeds[z->speed] + '0');
+        LCD_Cursor(0);
+    }
+}
+
+void fan_toggleOscillate() {
+    if(oscillateOn == 0x00) {
+        oscillateOn = 0x01;
+        LCD_Cursor(13);
+        LCD_WriteData('O');
+        LCD_WriteData('n');
+        LCD_WriteData(' ');
+        LCD_Cursor(0);
+    } else {
+        oscillateOn = 0x00;
+        LCD_Cursor(13);
+        LCD_WriteData('O');
+        LCD_WriteData('f');
+        LCD_WriteData('f');
+        LCD_Cursor(0);
+    }
+}
+
+// Temperature mode: a zone's fan runs while it is warmer than its threshold
+void temp_Apply(volatile zone_t *z, unsigned char sample) {
+    z->temp = sample;
+    if(z->tempMode == 0x01 && z->on != (z->temp > z->threshold))
+        fan_setPower(z, z->temp > z->threshold);
+}
+
+// CMD_TEMP: a reading from elsewhere (the bus master's) stands in for a
+// zone's own sensor while they keep coming
+#define TEMP_SHARED_MS 5000
+unsigned char tempShared[ZONES];   // a shared reading is in force
+unsigned long tempSharedAt[ZONES]; // ticks_now() of the last one
+
+void temp_Share(unsigned char i, unsigned char sample) {
+    tempShared[i] = 1;
+    tempSharedAt[i] = ticks_now();
+    temp_Apply(&zones[i], sample);
+}
+
+// A zone's own sensor, unless a shared reading is in force
+void temp_Sensor(unsigned char i, unsigned char sample) {
+    if(tempShared[i] && ticks_now() - tempSharedAt[i] < (unsigned long)TEMP_SHARED_MS * TICKS_PER_MS)
+        return;
+    tempShared[i] = 0;
+    temp_Apply(&zones[i], sample);
+}
+
+// Multi-zone units page with the Osc button; oscillation is left on the
+// remote's FUNC/STOP, as a code no button mask makes
+#if ZONES > 1
+#define F_OSC  0x10
+#define F_PAGE 0x02
+#else
+#define F_OSC  0x02
+#endif
+
+// Button an IR remote key stands for (keyValue[] order in IR.h)
+unsigned char F_irButton(unsigned char key) {
+    switch(key) {
+        case 0:  return 0x08; // POWER
+        case 2:             // VOL+
+        case 8:  return 0x04; // UP
+        case 1:  return F_OSC; // FUNC/STOP
+        case 9:  return 0x01; // EQ
+#if ZONES > 1
+        case 5:  return F_PAGE; // FAST FORWARD
+#endif
+        default: return 0x00;
+    }
+}
+
+// Input task: drains every event queued by the ISRs since the last tick.
+// Buttons and the remote work the zone on the status display.
 void F_Tick() {
-    tempA = ~PINA;
-    switch(F_state) { // transitions
-        case F_start:
-            F_state = F_wait;
-            break;
-        case F_wait:
-            if((tempA & 0x0F) == 0x08 && fanOn == 0x00) {
-                F_state = F_on;
-            }
-            else if((tempA & 0x0F) == 0x08 && fanOn == 0x01) {
-                F_state = F_off;
-            }
-            else if((tempA & 0x0F) == 0x04) {
-                F_state = F_setSpeed;
-            }
-            else if((tempA & 0x0F) == 0x02) {
-                F_state = F_oscillate;
-            }
-            else if((tempA & 0x0F) == 0x01) {
-                F_state = F_tempMode;
-            }
-            else {
-                F_state = F_wait;
-            }
-            break;
-        case F_off:
-            F_state = F_press;
-            break;
-        case F_on:
-            F_state = F_press;
-            break;
-        case F_setSpeed:
-            F_state = F_press;
-            break;
-        case F_tempMode:
-            F_state = F_press;
-            break;
-        case F_oscillate:
-            F_state = F_press;
-            break;
-        case F_press:
-            if((tempA & 0x0F) != 0x00) {
-                F_state = F_press;
-            }
-            else {
-                F_state = F_wait;
-            }
-            break;
-        default:
-            F_state = F_start;
-            break;
-    }
-    switch(F_state) { // actions
-        case F_start:
-            break;
-        case F_wait:
-            // LCD_DisplayString(1, "Wait state"); // test line
-            break;
-        case F_off:
-            fanOn = 0x00;
-            LCD_Cursor(5);
-            LCD_WriteData('O');
-            LCD_WriteData('f');
-            LCD_WriteData('f');
-            LCD_Cursor(0);
-            break;
-        case F_on:
-            fanOn = 0x01;
-            LCD_Cursor(5);
-            LCD_WriteData('O');
-            LCD_WriteData('n');
-            LCD_WriteData(' ');
-            LCD_Cursor(0);
-            break;
-        case F_setSpeed:
-            if(tempMode == 0x00) {
-                pos_speed++;
-                LCD_Cursor(21);
-                if(pos_speed == maxSpeed) {
-                    pos_speed = 0;
-                    LCD_WriteData(speeds[pos_speed] + '0');
-                } else {
-                    LCD_WriteData(speeds[pos_speed] + '0');
-                }
-                LCD_Cursor(0);
-            }
-            break;
-        case F_tempMode:
-            if(tempMode == 0x00) {
-                tempMode = 0x01;
-                LCD_Cursor(21);
-                LCD_WriteData('T');
-                LCD_WriteData('e');
-                LCD_WriteData('m');
-                LCD_WriteData('p');
-                LCD_Cursor(0);
-            } else {
-                tempMode = 0x00;
-                LCD_Cursor(21);
-                LCD_WriteData(' ');
-                LCD_WriteData(' ');
-                LCD_WriteData(' ');
-                LCD_WriteData(' ');
-                
-                LCD_Cursor(21);
-                LCD_WriteData(speeds[pos_speed] + '0');
-                LCD_Cursor(0);
-            }
-            break;
-        case F_oscillate:
-            if(oscillateOn == 0x00) {
-                oscillateOn = 0x01;
-                LCD_Cursor(13);
-                LCD_WriteData('O');
-                LCD_WriteData('n');
-                LCD_WriteData(' ');
-                LCD_Cursor(0);
-            } else {
-                oscillateOn = 0x00;
-                LCD_Cursor(13);
-                LCD_WriteData('O');
-                LCD_WriteData('f');
-                LCD_WriteData('f');
-                LCD_Cursor(0);
-            }
-            break;
-        case F_press:
-            break;
-        default:
-            break;
+    event_t e;
+    unsigned char button;
+    volatile zone_t *z;
+
+    power_responsive(); // first input poll after a wake
+    while(evq_pop(&inputQueue, &e)) {
+        if(e.type == EV_TEMP) {
+            temp_Sensor(e.arg, adcSamples[e.arg]);
+            continue;
+        }
+        z = &zones[zoneShown];
+        button = (e.type == EV_IR) ? F_irButton(e.arg) : e.arg;
+        switch(button) {
+            case 0x08:
+                fan_setPower(z, !z->on);
+                break;
+            case 0x04:
+                fan_nextSpeed(z);
+                break;
+            case F_OSC:
+                fan_toggleOscillate();
+                break;
+            case 0x01:
+                fan_toggleTempMode(z);
+                break;
+#if ZONES > 1
+            case F_PAGE:
+                zoneShown = (zoneShown + 1 < ZONES) ? zoneShown + 1 : 0;
+                break;
+#endif
+            default: // several buttons at once: ignored, as before
+                break;
+        }
     }
+}
+
+// Speed hold: closed loop on zone 0's tach. motorLimit replaces
+// motorSpeeds[speed] as the PWM limit and is trimmed towards the
+// preset's target rpm; no tach edges while driven means a stall.
+#define STALL_MS 3000
+unsigned short rpmTargets[maxSpeed] = {600, 1200, 2000, 2600};
+volatile unsigned char speedHold = 0x00; // 1: closed loop, 2: fixed motorLimit (CMD_DUTY)
+volatile unsigned char motorLimit = 11;
+unsigned short stallTime = 0;    // ms driven without tach edges
+unsigned char holdSpeed = 0xFF;  // preset the loop was started for
 
+// PWM limit of a zone: on while 10 < motor <= limit, out of 0 .. limit
+unsigned char M_limit(unsigned char i) {
+    return (i == 0 && speedHold) ? motorLimit : motorSpeeds[zones[i].speed];
 }
 
-unsigned char motor = 0x00;
-unsigned char motorEnable = 0x00;
+// Motor of zone i. Zone 0 is switched on the 1 ms tick; zones 1-3 get the
+// same duty from their timer (zone.h), set whenever it changes.
 unsigned char motorDir = 0x02; // 1 for fwd, 2 for bkwd
-enum motorStates {M_start, M_off, M_on} M_state;
-void M_Tick() {
-    switch(M_state) { // transitions
+enum motorStates {M_start, M_off, M_on};
+void M_Tick(unsigned char i) {
+    volatile zone_t *z = &zones[i];
+    unsigned char limit;
+    unsigned char duty = 0;
+
+    switch(z->state) { // transitions
         case M_start:
-            M_state = M_off;
+            z->state = M_off;
             break;
         case M_off:
-            if(fanOn == 0x00)
-                M_state = M_off;
-            else if(fanOn == 0x01)
-                M_state = M_on;
+            if(z->on == 0x00 || z->stall == 0x01)
+                z->state = M_off;
+            else if(z->on == 0x01)
+                z->state = M_on;
             break;
         case M_on:
-            if(fanOn == 0x00)
-                M_state = M_off;
-            else if(fanOn == 0x01)
-                M_state = M_on;
+            if(z->on == 0x00 || z->stall == 0x01)
+                z->state = M_off;
+            else if(z->on == 0x01)
+                z->state = M_on;
             break;
         default:
-            M_state = M_start;
+            z->state = M_start;
             break;
     }
-    switch(M_state) { // state actions
+    switch(z->state) { // state actions
         case M_start:
             break;
         case M_off:
-            motorEnable = 0x00;
+            z->enable = 0x00;
             break;
         case M_on:
-            if(motor <= 10) 
-                motorEnable = 0x00;
-            else if (motor <= motorSpeeds[pos_speed]) 
-                motorEnable = 0x01;
+            limit = M_limit(i);
+            if(i != 0) {
+                duty = (unsigned short)(limit - 10) * 256 / (limit + 1);
+                z->enable = 0x01;
+                break;
+            }
+            if(z->motor <= 10) 
+                z->enable = 0x00;
+            else if (z->motor <= limit) 
+                z->enable = 0x01;
             else
-                motor = 0;
-            motor++;
+                z->motor = 0;
+            z->motor++;
+            break;
+        default:
+            break;
+    }
+    if(i != 0 && duty != z->pwm) {
+        zone_pwm(i, duty);
+        z->pwm = duty;
+    }
+}
 
-            // motorEnable = 0x01;
+enum holdStates {H_start, H_open, H_hold} H_state;
+void H_Tick() {
+    volatile zone_t *z = &zones[0];
+    signed short step;
 
+    switch(H_state) { // transitions
+        case H_start:
+            H_state = H_open;
+            break;
+        case H_open:
+            if(speedHold == 0x01 && z->on == 0x01)
+                H_state = H_hold;
+            break;
+        case H_hold:
+            if(speedHold == 0x00 || z->on == 0x00)
+                H_state = H_open;
+            break;
+        default:
+            H_state = H_start;
+            break;
+    }
+    switch(H_state) { // state actions
+        case H_start:
+            break;
+        case H_open:
+            holdSpeed = 0xFF;
+            stallTime = 0;
+            if(z->on == 0x00)
+                z->stall = 0x00;
+            break;
+        case H_hold:
+            if(holdSpeed != z->speed) {
+                // new preset: start from its open-loop duty
+                motorLimit = motorSpeeds[z->speed];
+                holdSpeed = z->speed;
+                stallTime = 0;
+            }
+            if(tachRpm == 0 && z->stall == 0x00) {
+                stallTime += 100;
+                if(stallTime >= STALL_MS)
+                    z->stall = 0x01;
+                break;
+            }
+            stallTime = 0;
+            // integral trim, at most 8 steps per 100 ms
+            step = ((signed short)rpmTargets[z->speed] - (signed short)tachRpm) / 64;
+            if(step > 8)
+                step = 8;
+            else if(step < -8)
+                step = -8;
+            step += motorLimit;
+            if(step < 11)
+                step = 11;
+            else if(step > 250)
+                step = 250;
+            motorLimit = step;
             break;
         default:
             break;
@@ -261,19 +395,32 @@ unsigned char servoTime = 0x00;
 static unsigned char servoWait = 0x00;
 unsigned char left = 2;
 unsigned char right = 1;
-enum oscillatorStates{osc_start, osc_off, osc_wait, osc_left, osc_right} osc_state;
+volatile unsigned char servoHold = 0xFF; // angle to hold while not oscillating (CMD_SERVO), 0xFF: none
+volatile unsigned char servoPulse = 1;   // pulse width for servoHold, same units as left/right
+enum oscillatorStates{osc_start, osc_off, osc_wait, osc_left, osc_right, osc_hold} osc_state;
 void osc_Tick() {
     switch(osc_state) { // transitions
         case osc_start:
             osc_state = osc_off;
             break;
         case osc_off:
-            if(oscillateOn == 0x00) {
+            if(oscillateOn == 0x01) {
+                osc_state = osc_left;
+            }
+            else if(servoHold != 0xFF) {
+                osc_state = osc_hold;
+            }
+            else {
                 osc_state = osc_off;
             }
-            else if(oscillateOn == 0x01) {
+            break;
+        case osc_hold:
+            if(oscillateOn == 0x01) {
                 osc_state = osc_left;
             }
+            else if(servoHold == 0xFF) {
+                osc_state = osc_off;
+            }
             break;
         case osc_left:
             if(oscillateOn == 0x00) {
@@ -362,28 +509,159 @@ void osc_Tick() {
                 }
                 servoTime++;
             break;
+        case osc_hold:
+            if(servoTime <= servoPulse) {
+                servoMotor = 0x01;
+            }
+            else if (servoTime <= 20) {
+                servoMotor = 0x00;
+            }
+            else {
+                servoTime = 0x00;
+            }
+            servoTime++;
+            break;
         default:
             break;
     }
 }
 
-unsigned char turn = 0x00;
+#ifdef DISPLAY_LINK
+// Split build: the display MCU owns both Nokia displays (link.h)
+#define display_busy() 0 // not activity: the periodic resend would hold off standby, which drains the link itself
+#else
+nokia_lcd_t lcdFan;    // fan animation display
+nokia_lcd_t lcdStatus; // status display
+#define display_busy() nokia_bus_busy()
+#endif
+
+unsigned char d1_shown = 0xFF; // status last drawn on lcdStatus
+#ifdef DISPLAY_LINK
+unsigned char d1_refresh = 0;  // d1 ticks since the last full resend
+
+// Status fields for the display MCU, 1 once queued
+unsigned char d1_send(volatile zone_t *z) {
+    unsigned char fields[LINK_FIELDS * 2] = {
+        LINK_FIELD_POWER, z->on, LINK_FIELD_OSC, oscillateOn,
+        LINK_FIELD_TEMP, z->tempMode, LINK_FIELD_SPEED, speeds[z->speed]};
+#if ZONES > 1
+    unsigned char text[] = {3, 'Z', 'o', 'n', 'e', ':', ' ', zoneShown + '1'};
+
+    if(!link_send(LINK_TEXT, text, sizeof(text)))
+        return 0;
+#endif
+    return link_send(LINK_STATUS, fields, sizeof(fields));
+}
+#endif
+enum display1_States{d1_start, d1_update} d1_state;
+void d1_Tick() {
+    volatile zone_t *z = &zones[zoneShown];
+    unsigned char status = z->on + (oscillateOn << 1) + (z->tempMode << 2) + (z->speed << 3)
+        + (zoneShown << 5);
+    switch(d1_state) { // transitions
+        case d1_start:
+            d1_state = d1_update;
+            break;
+        case d1_update:
+            d1_state = d1_update;
+            break;
+        default:
+            d1_state = d1_start;
+            break;
+    }
+    switch(d1_state) { // state actions
+        case d1_start:
+            break;
+        case d1_update:
+#ifdef DISPLAY_LINK
+            if(++d1_refresh >= LINK_REFRESH_MS / 100) { // d1 runs every 100 ms
+                d1_refresh = 0;
+                d1_shown = 0xFF;
+            }
+            if(status != d1_shown && d1_send(z))
+                d1_shown = status;
+#else
+            if(status != d1_shown) {
+                nokia_lcd_clear(&lcdStatus);
+                nokia_lcd_write_string_P(&lcdStatus, PSTR("Pwr: "), 1);
+                nokia_lcd_write_string_P(&lcdStatus, z->on ? PSTR("On") : PSTR("Off"), 1);
+                nokia_lcd_set_cursor(&lcdStatus, 0, 8);
+                nokia_lcd_write_string_P(&lcdStatus, PSTR("Osc: "), 1);
+                nokia_lcd_write_string_P(&lcdStatus, oscillateOn ? PSTR("On") : PSTR("Off"), 1);
+                nokia_lcd_set_cursor(&lcdStatus, 0, 16);
+                nokia_lcd_write_string_P(&lcdStatus, PSTR("Spd: "), 1);
+                if(z->tempMode == 0x01)
+                    nokia_lcd_write_string_P(&lcdStatus, PSTR("Temp"), 1);
+                else
+                    nokia_lcd_write_char(&lcdStatus, speeds[z->speed] + '0', 1);
+#if ZONES > 1
+                nokia_lcd_set_cursor(&lcdStatus, 0, 24);
+                nokia_lcd_write_string_P(&lcdStatus, PSTR("Zone: "), 1);
+                nokia_lcd_write_char(&lcdStatus, zoneShown + '1', 1);
+#endif
+                nokia_lcd_flush(&lcdStatus);
+                d1_shown = status;
+            }
+#endif
+            break;
+        default:
+            break;
+    }
+}
+
+// Animation phase accumulator: one full turn of fanFrames is 0x10000.
+// The step per d2 tick follows the motor duty, so the picture spins
+// at a rate tied to the actual speed.
+#define FAN_PHASE_MAX_STEP (0x10000 / FAN_FRAME_COUNT) // one frame per tick at 100% duty
+unsigned short fanPhase = 0x0000;
+unsigned short fanPhaseStep = 0x0000;
+unsigned char fanFrame = 0x00; // frame currently in lcdFan
+#ifdef DISPLAY_LINK
+unsigned char d2_refresh = 0;   // d2 ticks since fanFrame was last sent
+#endif
+
+// Draw a frame and queue it for the display; a frame the link had no
+// room for is simply tried again on the next d2 tick
+void d2_drawFrame(unsigned char frame) {
+#ifdef DISPLAY_LINK
+    if(link_send(LINK_FRAME, &frame, 1))
+        fanFrame = frame;
+#else
+    nokia_lcd_clear(&lcdFan);
+    nokia_lcd_set_cursor(&lcdFan, 18, 0);
+    nokia_lcd_write_bitmap_P(&lcdFan, fanFrames[frame], FAN_FRAME_WIDTH, FAN_FRAME_BANKS);
+    nokia_lcd_flush(&lcdFan);
+    fanFrame = frame;
+#endif
+}
+
+// The animation shows the zone on the status display
 enum display2_States{d2_start, d2_output, d2_pause} d2_state;
 void d2_Tick() {
+    volatile zone_t *z = &zones[zoneShown];
+    unsigned char limit = M_limit(zoneShown);
+    unsigned short target = 0;
+    unsigned char frame;
+
+    // duty of the M_Tick PWM, as tel_duty: on for motor = 11..limit out of
+    // 0..limit, with speed hold's limit and nothing while stalled
+    if(z->state == M_on)
+        target = (unsigned long)FAN_PHASE_MAX_STEP * (limit - 10) / (limit + 1);
+
     switch(d2_state) { // transitions
         case d2_start:
             d2_state = d2_pause;
             break;
         case d2_output:
-            if(fanOn == 0x01)
-                d2_state = d2_output;
-            else if(fanOn == 0x00)
+            if(z->on == 0x00 && fanPhaseStep == 0)
                 d2_state = d2_pause;
+            else
+                d2_state = d2_output;
             break;
         case d2_pause:
-            if(fanOn == 0x01)
+            if(z->on == 0x01)
                 d2_state = d2_output;
-            else if(fanOn == 0x00)
+            else
                 d2_state = d2_pause;
             break;
         default:
@@ -394,28 +672,618 @@ void d2_Tick() {
         case d2_start:
             break;
         case d2_output:
-            if(turn == 0x00) {
-                nokia_lcd_clear();
-                nokia_lcd_set_cursor(18,0);
-                nokia_lcd_write_bitmap(fan02_45);
-                nokia_lcd_render();
-                turn = 0x01;
+            // ease towards the target step so the blades spin up and down
+            if(fanPhaseStep < target)
+                fanPhaseStep += (target - fanPhaseStep + 7) >> 3;
+            else
+                fanPhaseStep -= (fanPhaseStep - target + 7) >> 3;
+            fanPhase += fanPhaseStep;
+            frame = ((fanPhase >> 8) * FAN_FRAME_COUNT) >> 8;
+            if(frame != fanFrame)
+                d2_drawFrame(frame);
+            break;
+        case d2_pause:
+            fanPhaseStep = 0;
+            break;
+        default:
+            break;
+    }
+#ifdef DISPLAY_LINK
+    if(++d2_refresh >= LINK_REFRESH_MS / 40) { // d2 runs every 40 ms
+        d2_refresh = 0;
+        link_send(LINK_FRAME, &fanFrame, 1);
+    }
+#endif
+}
+
+#ifdef TEMP_ONEWIRE
+// 1-Wire sensor (onewire.h): start a conversion, come back for it
+// ONEWIRE_CONVERT_MS later, one reading every TEMP_PERIOD_MS. The bus
+// transactions run in the Timer2 ISR; this only starts and collects them.
+#define TEMP_TICK_MS 10
+#define TEMP_PERIOD_MS 1000
+enum temp_States{T_start, T_convert, T_wait, T_read, T_collect, T_idle} T_state;
+unsigned short T_count = 0; // ms since the conversion was started
+void T_Tick() {
+    switch(T_state) { // transitions
+        case T_start:
+            T_state = T_convert;
+            break;
+        case T_convert:
+            T_state = T_wait;
+            break;
+        case T_wait:
+            if(T_count >= ONEWIRE_CONVERT_MS)
+                T_state = T_read;
+            break;
+        case T_read:
+            T_state = T_collect;
+            break;
+        case T_collect:
+            if(onewire_status() != ONEWIRE_BUSY) {
+                if(onewire_status() == ONEWIRE_DONE)
+                    temp_Sensor(0, onewire_sample());
+                T_state = T_idle;
+            }
+            break;
+        case T_idle:
+            if(T_count >= TEMP_PERIOD_MS)
+                T_state = T_convert;
+            break;
+        default:
+            T_state = T_start;
+            break;
+    }
+    switch(T_state) { // state actions
+        case T_convert:
+            onewire_convert();
+            T_count = 0;
+            break;
+        case T_read:
+            onewire_read();
+            T_count += TEMP_TICK_MS;
+            break;
+        case T_wait:
+        case T_collect:
+        case T_idle:
+            T_count += TEMP_TICK_MS;
+            break;
+        default:
+            break;
+    }
+}
+
+// Watchdog wake in standby: collect the conversion started at the last
+// wake and start the next one, which runs in the sensor while the MCU
+// sleeps. Timer2 stops in power down, so both transactions (~10 ms) are
+// waited out here.
+unsigned char temp_readStandby(unsigned char i) {
+    unsigned char sample = zones[i].temp;
+
+    while(onewire_status() == ONEWIRE_BUSY) {}
+    onewire_read();
+    while(onewire_status() == ONEWIRE_BUSY) {}
+    if(onewire_status() == ONEWIRE_DONE)
+        sample = onewire_sample();
+    onewire_convert();
+    while(onewire_status() == ONEWIRE_BUSY) {}
+    return sample;
+}
+#else
+#define TEMP_TICK_MS 1000
+#define temp_readStandby(i) ADC_readTemp(i)
+
+enum temp_States{T_start, T_sample} T_state;
+void T_Tick() {
+    switch(T_state) { // transitions
+        case T_start:
+            T_state = T_sample;
+            break;
+        case T_sample:
+            T_state = T_sample;
+            break;
+        default:
+            T_state = T_start;
+            break;
+    }
+    switch(T_state) { // state actions
+        case T_start:
+            break;
+        case T_sample:
+            ADC_start(); // results come back to F_Tick as EV_TEMP, one per zone
+            break;
+        default:
+            break;
+    }
+}
+#endif
+
+// Settings persistence: restored at boot, staged on change (settings.c
+// coalesces and writes them in the background)
+void settings_Restore() {
+    settings_t s;
+    if(settings_load(&s)) {
+        zones[0].on = s.fanOn ? 0x01 : 0x00;
+        zones[0].speed = s.pos_speed < maxSpeed ? s.pos_speed : 0;
+        oscillateOn = s.oscillateOn ? 0x01 : 0x00;
+        zones[0].tempMode = s.tempMode ? 0x01 : 0x00;
+        zones[0].threshold = s.tempThreshold;
+    }
+}
+
+void S_Tick() {
+    settings_t s;
+    s.fanOn = zones[0].on;
+    s.pos_speed = zones[0].speed;
+    s.oscillateOn = oscillateOn;
+    s.tempMode = zones[0].tempMode;
+    s.tempThreshold = zones[0].threshold;
+    settings_save(&s);
+}
+
+// Full status line on the HD44780 for the current settings (32 chars and
+// a terminating 0)
+void status_Format(unsigned char *status) {
+    const char *text = "Pwr:Off Osc:Off Spd:1           ";
+    unsigned char i;
+    for(i = 0; i < 32; i++)
+        status[i] = text[i];
+    status[32] = '\0';
+    if(zones[0].on == 0x01) {
+        status[5] = 'n';
+        status[6] = ' ';
+    }
+    if(oscillateOn == 0x01) {
+        status[13] = 'n';
+        status[14] = ' ';
+    }
+    if(zones[0].tempMode == 0x01) {
+        status[20] = 'T';
+        status[21] = 'e';
+        status[22] = 'm';
+        status[23] = 'p';
+    } else {
+        status[20] = speeds[zones[0].speed] + '0';
+    }
+}
+
+// Boot profile, microseconds since TimerOn (read from gdb: printBoot)
+unsigned long bootControlUs = 0; // first M_Tick, motor outputs live
+unsigned long bootStatusUs = 0;  // HD44780 initialised and status drawn
+unsigned long bootFrameUs = 0;   // first fan frame on the Nokia display
+
+void boot_Mark(unsigned long *us) {
+    if(*us == 0)
+        *us = ticks_now() * TICKS_US;
+}
+
+// Background bring-up of the HD44780: init sequence, then the status line
+// one write per tick (both protothreads in io.c)
+unsigned char b1_status[33];
+enum boot1_States{b1_start, b1_init, b1_draw, b1_done} b1_state;
+void b1_Tick() {
+    switch(b1_state) { // transitions
+        case b1_start:
+            b1_state = b1_init;
+            break;
+        case b1_init:
+            if(LCD_init_Tick()) {
+                status_Format(b1_status);
+                b1_state = b1_draw;
             }
-            else if (turn == 0x01) {
-                nokia_lcd_clear();
-                nokia_lcd_set_cursor(18,0);
-                nokia_lcd_write_bitmap(fan02);
-                nokia_lcd_render();
-                turn = 0x00;
+            break;
+        case b1_draw:
+            if(LCD_DisplayString_Tick(1, b1_status)) {
+                LCD_PutCommand(0x7F); // park the cursor like LCD_Cursor(0)
+                boot_Mark(&bootStatusUs);
+                b1_state = b1_done;
             }
             break;
-        case d2_pause:
+        case b1_done:
+            break;
+        default:
+            b1_state = b1_start;
+            break;
+    }
+    // no state actions: the protothreads do the writes from the transitions
+}
+
+// Background bring-up of the Nokia displays: bus reset, panel setup,
+// first frame queued on the arbiter
+enum boot2_States{b2_start, b2_reset, b2_panels, b2_done} b2_state;
+void b2_Tick() {
+    switch(b2_state) { // transitions
+        case b2_start:
+            b2_state = b2_reset;
+            break;
+        case b2_reset:
+#ifdef DISPLAY_LINK
+            b2_state = b2_panels; // the display MCU resets its panels itself
+#else
+            if(nokia_bus_init_Tick())
+                b2_state = b2_panels;
+#endif
+            break;
+        case b2_panels:
+            b2_state = b2_done;
+            break;
+        case b2_done:
+            break;
+        default:
+            b2_state = b2_start;
+            break;
+    }
+    switch(b2_state) { // state actions
+        case b2_panels:
+#ifdef DISPLAY_LINK
+            link_init();
+#else
+            nokia_lcd_init(&lcdFan, LCD_SCE, 2);
+            nokia_lcd_init(&lcdStatus, LCD_SCE2, 1);
+            nokia_lcd_set_font(&lcdStatus, NOKIA_FONT_PROP);
+#endif
+            d2_drawFrame(0);
+            break;
+        case b2_done:
+#ifdef DISPLAY_LINK
+            if(link_idle()) // frame 0 handed to the display MCU
+#else
+            if(lcdFan.frames > 0) // the RAM clear and frame 0 go out as one transfer
+#endif
+                boot_Mark(&bootFrameUs);
             break;
         default:
             break;
     }
 }
 
+// Any zone's fan switched on
+unsigned char zones_on() {
+    unsigned char i;
+    for(i = 0; i < ZONES; i++)
+        if(zones[i].on)
+            return 1;
+    return 0;
+}
+
+// Any zone in temperature mode
+unsigned char zones_tempMode() {
+    unsigned char i;
+    for(i = 0; i < ZONES; i++)
+        if(zones[i].tempMode)
+            return 1;
+    return 0;
+}
+
+// Standby while every fan is off: both displays powered down, MCU in
+// POWER_DOWN until a button or IR edge. With a zone in temperature mode
+// the watchdog wakes the MCU every ~8 s for a temperature check.
+#define STANDBY_IDLE_MS 5000
+void standby() {
+    unsigned char wake;
+    unsigned char i;
+#ifdef DISPLAY_LINK
+    unsigned char power = 0;
+
+    link_send(LINK_POWER, &power, 1);
+#else
+
+    nokia_lcd_power(&lcdFan, 0);
+    nokia_lcd_power(&lcdStatus, 0);
+#endif
+    LCD_Display(0);
+#ifdef REPLAY
+    while(uart_txFree() < REPLAY_LOG_LINE) {} // waits for the ring below anyway
+    printf("rp %lu standby\n", ticks_now() / TICKS_PER_MS);
+#endif
+    while(!uart_idle()) {} // let the last frame out, at most UART_TX_SIZE bytes
+#ifdef DISPLAY_LINK
+    while(!link_idle()) {}
+#endif
+#ifdef TEMP_ONEWIRE
+    while(onewire_status() == ONEWIRE_BUSY) {} // Timer2 would stop mid-slot
+#endif
+    do {
+        wake = power_sleep(zones_tempMode());
+        if(wake == POWER_WAKE_WDT)
+            for(i = 0; i < ZONES; i++)
+                temp_Apply(&zones[i], temp_readStandby(i));
+    } while(wake == POWER_WAKE_WDT && !zones_on());
+    history_wake();
+#ifdef TEMP_ONEWIRE
+    T_state = T_start; // the standby transactions replaced the task's
+#endif
+#ifdef REPLAY
+    printf("rp %lu wake %u\n", ticks_now() / TICKS_PER_MS, wake); // the ring is empty
+#endif
+    LCD_Display(1);
+#ifdef DISPLAY_LINK
+    power = 1;
+    link_send(LINK_POWER, &power, 1);
+#else
+    nokia_lcd_power(&lcdFan, 1);
+    nokia_lcd_power(&lcdStatus, 1);
+#endif
+}
+
+// Loop timing, reset by every telemetry frame
+unsigned short loopMax = 0;      // longest iteration, 8 us counts
+unsigned char loopOverruns = 0;  // iterations that ran past their 1 ms tick
+unsigned char histOverruns = 0;  // the same, reset by every history sample
+volatile unsigned char fgMax = 0; // longest fg_Tick, 8 us counts past its compare match, 0xFF: past the next one
+#ifdef REPLAY
+unsigned short telemetryPeriod = 0; // the replay log has the UART
+#elif defined(BUS_NODE)
+unsigned short telemetryPeriod = 0; // USART0 is the bus, only the master talks unprompted
+#else
+unsigned short telemetryPeriod = TELEMETRY_PERIOD_MS; // 0: telemetry off
+#endif
+
+// Zone 0's mode flags for telemetry and the history log (TELEMETRY_MOTOR aside)
+unsigned char tel_flags() {
+    return (zones[0].on ? TELEMETRY_FAN : 0) | (oscillateOn ? TELEMETRY_OSC : 0)
+        | (zones[0].tempMode ? TELEMETRY_TEMP : 0) | (speedHold ? TELEMETRY_HOLD : 0)
+        | (zones[0].stall ? TELEMETRY_STALL : 0);
+}
+
+// Zone 0's motor PWM duty in percent
+unsigned char tel_duty() {
+    unsigned char limit = M_limit(0);
+
+    // M_Tick drives the motor for motor = 11..limit out of 0..limit
+    return (zones[0].state == M_on) ? (unsigned short)(limit - 10) * 100 / (limit + 1) : 0;
+}
+
+void tel_Tick() {
+    telemetry_t t;
+
+    t.ms = (unsigned short)(ticks_now() / TICKS_PER_MS); // TimerTicks, read with interrupts off
+    t.states[0] = zones[0].state;
+    t.states[1] = osc_state;
+    t.states[2] = d2_state;
+    t.states[3] = H_state;
+    t.flags = tel_flags() | (zones[0].enable ? TELEMETRY_MOTOR : 0);
+    t.speed = zones[0].speed;
+    t.duty = tel_duty();
+    t.servo = (osc_state == osc_left) ? left : (osc_state == osc_right) ? right
+        : (osc_state == osc_hold) ? servoPulse : 0;
+    t.temp = zones[0].temp;
+    t.threshold = zones[0].threshold;
+    t.rpm = tachRpm;
+    t.loopMax = loopMax;
+    t.overruns = loopOverruns;
+    t.fgMax = fgMax;
+    t.fgSkipped = fgSkipped;
+    t.evqDropped = inputQueue.dropped;
+    t.uartDropped = uartDropped;
+    t.stackFree = stackFree;
+    if(uart_sendFrame(TELEMETRY_FRAME, &t, sizeof(t))) {
+        loopMax = 0;
+        loopOverruns = 0;
+        fgMax = 0;
+        fgSkipped = 0;
+    }
+}
+
+// History log (history.h), every second
+void hist_Tick() {
+    history_sample_t s;
+
+    if(!history_second())
+        return;
+    s.temp = zones[0].temp;
+    s.duty = tel_duty();
+    s.flags = tel_flags();
+    s.overruns = histOverruns;
+    histOverruns = 0;
+    history_add(&s);
+}
+
+// Runs one op of a command frame, returns its CMD_* status. Zone ops work
+// cmdZone, zone 0 unless the frame selected another with CMD_ZONE.
+unsigned char cmdZone = 0;
+unsigned char C_Op(unsigned char op, unsigned char arg) {
+    volatile zone_t *z = &zones[cmdZone];
+
+    switch(op) {
+        case CMD_POWER:
+            if(arg > 1)
+                return CMD_BAD_ARG;
+            if(z->on != arg)
+                fan_setPower(z, arg);
+            break;
+        case CMD_SPEED:
+            if(arg >= maxSpeed)
+                return CMD_BAD_ARG;
+            fan_setSpeed(z, arg);
+            break;
+        case CMD_DUTY:
+            // duty of M_Tick is (limit - 10) / (limit + 1)
+            if(arg > 100 || cmdZone != 0)
+                return CMD_BAD_ARG;
+            motorLimit = (arg >= 96) ? 250 : (1000 + arg) / (100 - arg);
+            speedHold = 0x02;
+            break;
+        case CMD_HOLD:
+            if(arg > 1 || cmdZone != 0) // the tach is zone 0's
+                return CMD_BAD_ARG;
+            speedHold = arg;
+            break;
+        case CMD_SERVO:
+            if(arg > 180 && arg != 0xFF)
+                return CMD_BAD_ARG;
+            if(arg != 0xFF && oscillateOn == 0x01)
+                fan_toggleOscillate();
+            // the pulse is generated in 1 ms steps, so this rounds to right or left
+            if(arg != 0xFF)
+                servoPulse = right + ((unsigned short)arg * (left - right) + 90) / 180;
+            servoHold = arg;
+            break;
+        case CMD_OSC:
+            if(arg > 1)
+                return CMD_BAD_ARG;
+            if(oscillateOn != arg)
+                fan_toggleOscillate();
+            break;
+        case CMD_TEMPMODE:
+            if(arg > 1)
+                return CMD_BAD_ARG;
+            if(z->tempMode != arg)
+                fan_toggleTempMode(z);
+            break;
+        case CMD_THRESHOLD:
+            z->threshold = arg;
+            break;
+        case CMD_TELEMETRY:
+#ifdef BUS_NODE
+            if(arg != 0)
+                return CMD_BAD_ARG; // unprompted frames on the bus (bus.h)
+#endif
+            telemetryPeriod = (unsigned short)arg * 10;
+            break;
+        case CMD_QUERY:
+            if(arg != 0)
+                return CMD_BAD_ARG;
+            break;
+        case CMD_HISTORY:
+#ifdef BUS_NODE
+            if(arg == 0)
+                return CMD_BAD_ARG; // the dump is a stream of frames
+#endif
+            if(arg == 0)
+                history_dump();
+            else if(arg == 1)
+                history_clear();
+            else if(arg == 2)
+                history_checkpoint();
+            else
+                return CMD_BAD_ARG;
+            break;
+        case CMD_HISTRATE:
+            historyPeriod = arg;
+            break;
+        case CMD_ZONE:
+            if(arg >= ZONES)
+                return CMD_BAD_ARG;
+            cmdZone = arg;
+            break;
+        case CMD_TEMP:
+            temp_Share(cmdZone, arg);
+            break;
+        default:
+            return CMD_BAD_OP;
+    }
+    return CMD_OK;
+}
+
+// Runs a batch of op/arg pairs in order, stopping at the first that fails.
+// Returns its CMD_* status (CMD_OK when all ran) and counts the ops done.
+unsigned char C_Run(const unsigned char *ops, unsigned char len, unsigned char *done) {
+    unsigned char status = (len & 1) ? CMD_BAD_FRAME : CMD_OK;
+    unsigned char i;
+
+    *done = 0;
+    cmdZone = 0;
+    for(i = 0; status == CMD_OK && i < len; i += 2) {
+        status = C_Op(ops[i], ops[i + 1]);
+        if(status == CMD_OK)
+            (*done)++;
+    }
+    return status;
+}
+
+#if defined(BUS_NODE) && BUS_NODE == BUS_MASTER
+// Bus master (bus.h): the nodes follow this fan
+void C_Tick() {
+    busGroup.on = zones[0].on;
+    busGroup.speed = zones[0].speed;
+    busGroup.temp = zones[0].temp;
+    bus_Tick();
+}
+#elif defined(BUS_NODE)
+// Command task of a bus node: runs the master's frames, answers the ones
+// addressed to this node with its status (bus.h)
+void C_Tick() {
+    bus_request_t r;
+    bus_status_t s;
+
+    while(bus_recv(&r)) {
+        s.status = C_Run(r.ops, r.len, &s.ops);
+        if(!r.reply)
+            continue;
+        s.seq = r.seq;
+        s.on = zones[0].on;
+        s.speed = zones[0].speed;
+        s.tempMode = zones[0].tempMode;
+        s.temp = zones[0].temp;
+        s.rpm = tachRpm;
+        bus_reply(&s);
+    }
+}
+#else
+// Command task: runs every frame received on USART0 since the last tick
+void C_Tick() {
+    uart_frame_t f;
+    unsigned char ack[3];
+    unsigned char query;
+    unsigned char i;
+
+    while(uart_recvFrame(&f)) {
+        if(f.type != CMD_FRAME)
+            continue;
+        ack[0] = f.len ? f.payload[0] : 0;
+        ack[2] = 0;
+        ack[1] = f.len ? C_Run(f.payload + 1, f.len - 1, &ack[2]) : CMD_BAD_FRAME;
+        query = 0;
+        for(i = 0; i < ack[2]; i++)
+            if(f.payload[1 + 2 * i] == CMD_QUERY)
+                query = 1;
+        uart_sendFrame(CMD_ACK, ack, sizeof(ack));
+        if(query)
+            tel_Tick();
+    }
+}
+#endif
+
+#ifdef REPLAY
+// Replay log: one line whenever a user-visible output changes, collected by
+// "make replay" (tools/replay.py log) and diffed against a golden log. A
+// line that doesn't fit the TX ring yet waits for a later tick: it is a
+// snapshot, so it goes out late rather than torn.
+#define RP_FIELDS 8
+unsigned char rp_shown[RP_FIELDS] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+unsigned short rp_settle = 0;
+void rp_Tick() {
+    unsigned char now[RP_FIELDS];
+    unsigned char i;
+
+    now[0] = zones[0].on;
+    now[1] = oscillateOn;
+    now[2] = zones[0].speed;
+    now[3] = zones[0].tempMode;
+    now[4] = zones[0].temp;
+    now[5] = zones[0].threshold;
+    now[6] = speedHold;
+    now[7] = zones[0].stall;
+    for(i = 0; i < RP_FIELDS && now[i] == rp_shown[i]; i++) {}
+    if(i < RP_FIELDS && uart_txFree() >= REPLAY_LOG_LINE) {
+        printf("rp %lu pwr=%u osc=%u spd=%u tmode=%u temp=%u thr=%u hold=%u stall=%u\n",
+            ticks_now() / TICKS_PER_MS, now[0], now[1], now[2], now[3], now[4], now[5], now[6], now[7]);
+        for(i = 0; i < RP_FIELDS; i++)
+            rp_shown[i] = now[i];
+    }
+    if(replayDone && rp_settle < REPLAY_SETTLE_MS)
+        rp_settle++;
+    if(rp_settle >= REPLAY_SETTLE_MS && uart_txFree() >= REPLAY_LOG_LINE) {
+        printf("rp %lu end dropped=%u\n", ticks_now() / TICKS_PER_MS, uartDropped);
+        while(!uart_idle()) {}
+        cli();
+        sleep_enable();
+        sleep_cpu(); // simavr exits on sleep with interrupts off
+    }
+}
+#endif
+
 enum output_States{out_start, out_output} out_state;
 void out_Tick() {
     switch(out_state) { // transitions
@@ -433,57 +1301,120 @@ void out_Tick() {
         case out_start:
             break;
         case out_output:
-            tempD = fanOn + (oscillateOn << 1) + (servoMotor << 2) + (motorEnable << 3) + (motorDir << 4);
-            PORTD = tempD;
+            // PD0/PD1 belong to USART0, so the status LEDs are on PA5/PA6
+            out_set(OUT_D, OUT_SERVO_MASK, servoMotor << PD2);
+            out_set(OUT_D, OUT_MOTOR_MASK, (zones[0].enable << PD3) | (motorDir << PD4));
+#if ZONES == 1
+            out_set(OUT_A, OUT_LEDS_MASK, (zones[0].on << PA5) | (oscillateOn << PA6));
+#endif
             break;
         default:
             break;
     }
 }
 
+// Foreground tier: called from the Timer1 compare ISR (timer.h) every
+// 1 ms, ahead of the loop below. The motor PWM, the servo pulse and the
+// output commit keep their timing however long F_Tick or the displays
+// take; everything else stays in the loop. Nothing here waits on a bus or
+// loops over more than the zones -- fgMax is the longest run. Other ISRs
+// can preempt it, so what it shares with them goes through out_set() and
+// ticks_now(), which mask interrupts themselves.
+void fg_Tick() {
+    unsigned char tick = (unsigned char)TimerTicks; // one byte, read whole
+    unsigned char i;
+    unsigned char t;
+
+    for(i = 0; i < ZONES; i++)
+        M_Tick(i);
+    boot_Mark(&bootControlUs);
+    osc_Tick();
+    out_Tick();
+    out_commit(); // one store per port for what the foreground set
+    // TCNT1 has wrapped if the run took past the next compare match
+    t = ((unsigned char)TimerTicks != tick) ? 0xFF : TCNT1;
+    if(t > fgMax)
+        fgMax = t;
+}
+
 int main(void) {
-    DDRA = 0x00; PORTA = 0xFF; // Input: Buttons, IR Receiver, Temperature Sensor
-    DDRB = 0xFF; PORTB = 0x00; // Output: LCD2 (The fan animation)
+#if ZONES > 3
+    DDRA = 0x00; PORTA = 0x0F; // Input: Buttons, zone thermistors (PA4-PA7, no pull-up)
+#elif ZONES > 1
+    DDRA = 0x00; PORTA = 0x1F; // Input: Buttons, IR Receiver, zone thermistors (PA7 down, no pull-up)
+#else
+    DDRA = 0x60; PORTA = 0x1F; // Input: Buttons, IR Receiver, Temperature Sensor (PA7, no pull-up). Output: status LEDs (PA5, PA6)
+#endif
+    DDRB = 0xFF; PORTB = 0x00; // Output: Nokia SPI bus (MOSI PB5, SCK PB7), LCD1 RS on PB4 (SS)
     DDRC = 0xFF; PORTC = 0x00; // Output: LCD1 (Status Display)
-    DDRD = 0xFF; PORTD = 0x00; // Output: Fan motor, oscillator, (and two status LEDs) + (LCD control)
+    DDRD = 0xBE; PORTD = 0x00; // Output: Fan motor, oscillator + (LCD control). PD0/PD1 USART0, PD6 tach input
     // DDRA = 0xFF; PORTA = 0x00; // LCD data lines
     // DDRD = 0xFF; PORTD = 0x00; // LCD control lines
 
     unsigned long F_elapsedTime = 0;
-    unsigned long M_elapsedTime = 0;
-    unsigned long osc_elapsedTime = 0;
+    unsigned long d1_elapsedTime = 0;
     unsigned long d2_elapsedTime = 0;
-    unsigned long out_elapsedTime = 0;
+    unsigned long bus_elapsedTime = 0;
+    unsigned long stack_elapsedTime = 0;
+    unsigned long T_elapsedTime = 0;
+    unsigned long S_elapsedTime = 0;
+    unsigned long ee_elapsedTime = 0;
+    unsigned long hist_elapsedTime = 0;
+    unsigned long idle_elapsedTime = 0;
+    unsigned long boot_elapsedTime = 0;
+    unsigned long H_elapsedTime = 0;
+    unsigned long tel_elapsedTime = 0;
+    unsigned long C_elapsedTime = 0;
+#ifdef REPLAY
+    unsigned long rp_elapsedTime = 0;
+#endif
+    unsigned long loopStart = 0;
     const unsigned long timerPeriod = 1;
+    unsigned char i;
 
     tempA = ~PINA;
     // tempB = ~PINB;
     // tempC = ~PINC;
     // tempD = ~PIND;
 
-    F_state = F_start;
-    M_state = M_start;
+    for(i = 0; i < ZONES; i++)
+        zones[i].state = M_start;
     osc_state = osc_start;
+    d1_state = d1_start;
     d2_state = d2_start;
     out_state = out_start;
-    
-
-    // ADC_init();
+    T_state = T_start;
+    b1_state = b1_start;
+    b2_state = b2_start;
+    H_state = H_start;
 
-    LCD_init();
-    LCD_ClearScreen();
+    out_init();
+    power_init();
+    zone_init(); // before the foreground tier can set a zone's duty
 
     TimerSet(1);
-    TimerOn();
-    
-    LCD_DisplayString(1, "Pwr:Off Osc:Off Spd:1          ");
-    LCD_Cursor(0);
+    TimerOn(); // foreground tier (fg_Tick) from here on
+    tach_init(); // input capture on Timer1, after TimerOn sets TIMSK1
+
+    settings_Restore(); // before the displays come up
+    history_init();
+
+#ifdef TEMP_ONEWIRE
+    onewire_init();
+#else
+    ADC_init();
+#endif
+    input_init();
+#ifdef BUS_NODE
+    bus_init(); // off the bus before USART0 can drive it
+#endif
+    uart_init();
+#ifdef REPLAY
+    stdout = &mystdout; // replay log
+#endif
 
-    nokia_lcd_init();
-    nokia_lcd_clear();
-    nokia_lcd_set_cursor(18,0);
-    nokia_lcd_write_bitmap(fan02);
-    nokia_lcd_render();
+    // Displays come up in the background (b1_Tick, b2_Tick) while the
+    // foreground tier already runs the motor, oscillator and outputs.
 
     // unsigned char motor = 0;
     // unsigned char oscil_motor = 0;
@@ -491,27 +1422,88 @@ int main(void) {
     // "Pwr:    Osc:    Spd:           "
 
     while (1) {
-        if(F_elapsedTime >= 10) {
+        loopStart = ticks_now();
+        if(boot_elapsedTime >= 1) {
+            b1_Tick();
+            b2_Tick();
+            boot_elapsedTime = 0;
+        }
+        if(F_elapsedTime >= 10 && b1_state == b1_done) {
             F_Tick();
             F_elapsedTime = 0;
         }
-        if(M_elapsedTime >= 1) {
-            M_Tick();
-            M_elapsedTime = 0;
+        if(C_elapsedTime >= 1 && b1_state == b1_done) {
+            C_Tick();
+            C_elapsedTime = 0;
         }
-        if(osc_elapsedTime >= 1) {
-            osc_Tick();
-            osc_elapsedTime = 0;
+        if(H_elapsedTime >= 100) {
+            tach_Tick();
+            H_Tick();
+            H_elapsedTime = 0;
+        }
+#ifdef TACH_SIM
+        tach_simTick(zones[0].enable);
+#endif
+        if(d1_elapsedTime >= 100 && b2_state == b2_done) {
+            d1_Tick();
+            d1_elapsedTime = 0;
         }
-        if(d2_elapsedTime >= 250) {
+        if(d2_elapsedTime >= 40 && b2_state == b2_done) {
             d2_Tick();
             d2_elapsedTime = 0;
         }
-        if(out_elapsedTime >= 1) {
-            out_Tick();
-            out_elapsedTime = 0;
+#ifndef DISPLAY_LINK
+        if(bus_elapsedTime >= 1) {
+            nokia_bus_Tick();
+            bus_elapsedTime = 0;
+        }
+#endif
+        if(stack_elapsedTime >= 10) {
+            stack_Tick();
+            stack_elapsedTime = 0;
+        }
+        if(T_elapsedTime >= TEMP_TICK_MS && b1_state == b1_done) {
+            T_Tick();
+            T_elapsedTime = 0;
         }
 
+        if(telemetryPeriod != 0 && tel_elapsedTime >= telemetryPeriod) {
+            tel_Tick();
+            tel_elapsedTime = 0;
+        }
+        if(S_elapsedTime >= 100) {
+            S_Tick();
+            S_elapsedTime = 0;
+        }
+        if(hist_elapsedTime >= 1000) {
+            hist_Tick();
+            hist_elapsedTime = 0;
+        }
+        if(ee_elapsedTime >= 1) {
+            settings_Tick();
+            history_Tick();
+            ee_elapsedTime = 0;
+        }
+
+#ifdef REPLAY
+        if(rp_elapsedTime >= 1 && b1_state == b1_done) {
+            rp_Tick();
+            rp_elapsedTime = 0;
+        }
+#endif
+        if(!zones_on() && oscillateOn == 0x00 && evq_empty(&inputQueue) && b1_state == b1_done
+                && b2_state == b2_done && !display_busy() && !settings_busy() && !history_busy()
+                && !uart_rxBusy())
+            idle_elapsedTime += timerPeriod;
+        else
+            idle_elapsedTime = 0;
+#ifndef BUS_NODE // bus nodes stay awake for the polls
+        if(idle_elapsedTime >= STANDBY_IDLE_MS) {
+            standby();
+            idle_elapsedTime = 0;
+        }
+#endif
+
         // // Code testing
         // if(oscil_motor <= 0) 
         //     PORTD = 0x04;
@@ -536,14 +1528,32 @@ int main(void) {
 
 
 
+        loopStart = ticks_now() - loopStart;
+        if(loopStart > loopMax)
+            loopMax = loopStart;
+        if(TimerFlag && loopOverruns < 0xFF)
+            loopOverruns++; // the next tick is already due
+        if(TimerFlag && histOverruns < 0xFF)
+            histOverruns++;
         while(!TimerFlag) {}
         TimerFlag = 0;
 
         F_elapsedTime += timerPeriod;
-        M_elapsedTime += timerPeriod;
-        osc_elapsedTime += timerPeriod;
+        d1_elapsedTime += timerPeriod;
         d2_elapsedTime += timerPeriod;
-        out_elapsedTime += timerPeriod;
+        bus_elapsedTime += timerPeriod;
+        stack_elapsedTime += timerPeriod;
+        T_elapsedTime += timerPeriod;
+        S_elapsedTime += timerPeriod;
+        ee_elapsedTime += timerPeriod;
+        hist_elapsedTime += timerPeriod;
+        boot_elapsedTime += timerPeriod;
+        H_elapsedTime += timerPeriod;
+        tel_elapsedTime += timerPeriod;
+        C_elapsedTime += timerPeriod;
+#ifdef REPLAY
+        rp_elapsedTime += timerPeriod;
+#endif
     }
     return 1;
 }
@@ -11,213 +11,637 @@
  * Original library written by SkewPL, http://skew.tk
  */
 
+/* The control MCU of the split build has no displays (link.h) */
+#ifndef DISPLAY_LINK
+
 #include "nokia5110.h"
+#include "pins.h"
+#include "pt.h"
 // #include "fanbitmaps.h"
 
 #include <avr/pgmspace.h>
 #include <avr/io.h>
-#include <util/delay.h>
 #include "nokia5110_chars.h"
+#include "nokia5110_font_prop.h"
+
+
+/* Panels sharing the bus, in registration order */
+static nokia_lcd_t *panels[NOKIA_MAX_PANELS];
+static uint8_t panel_count = 0;
+
+/*
+ * Select/deselect one controller. Only two chip-selects are wired, so
+ * each is a constant pin and one cbi/sbi rather than a shifted mask.
+ */
+static inline void select(const nokia_lcd_t *lcd)
+{
+	if (lcd->sce == LCD_SCE2)
+		PIN_LOW(LCD_SCE2_PIN);
+	else
+		PIN_LOW(LCD_SCE_PIN);
+}
+
+static inline void deselect(const nokia_lcd_t *lcd)
+{
+	if (lcd->sce == LCD_SCE2)
+		PIN_HIGH(LCD_SCE2_PIN);
+	else
+		PIN_HIGH(LCD_SCE_PIN);
+}
+
+/*
+ * Bus transport: start a byte, wait until the next one can be started,
+ * wait until the last one is out (before SCE goes high)
+ */
+#ifdef NOKIA_USART
+static inline void bus_write(uint8_t bytes)
+{
+	UCSR1A = (1 << TXC1);
+	UDR1 = bytes;
+}
+
+static inline void bus_ready(void)
+{
+	while (!(UCSR1A & (1 << UDRE1)))
+		;
+}
 
+static inline void bus_done(void)
+{
+	while (!(UCSR1A & (1 << TXC1)))
+		;
+}
+#else
+static inline void bus_write(uint8_t bytes)
+{
+	SPDR = bytes;
+}
 
-static struct {
-    /* screen byte massive */
-    uint8_t screen[504];
+static inline void bus_ready(void)
+{
+	while (!(SPSR & (1 << SPIF)))
+		;
+}
 
-    /* cursor position */
-    uint8_t cursor_x;
-    uint8_t cursor_y;
+#define bus_done() bus_ready()
+#endif
 
-} nokia_lcd = {
-    .cursor_x = 0,
-    .cursor_y = 0
-};
+/*
+ * Shift one byte out on DIN/CLK, MSB first
+ * Controller must already be selected and DC set
+ */
+static void shift(uint8_t bytes)
+{
+	bus_write(bytes);
+	bus_done();
+}
 
 /**
  * Sending data to LCD
+ * @lcd: target display
  * @bytes: data
  * @is_data: transfer mode: 1 - data; 0 - command;
  */
-static void write(uint8_t bytes, uint8_t is_data)
+static void write(const nokia_lcd_t *lcd, uint8_t bytes, uint8_t is_data)
 {
-	register uint8_t i;
 	/* Enable controller */
-	PORT_LCD &= ~(1 << LCD_SCE);
+	select(lcd);
 
 	/* We are sending data */
 	if (is_data)
-		PORT_LCD |= (1 << LCD_DC);
+		PIN_HIGH(LCD_DC_PIN);
 	/* We are sending commands */
 	else
-		PORT_LCD &= ~(1 << LCD_DC);
+		PIN_LOW(LCD_DC_PIN);
 
 	/* Send bytes */
-	for (i = 0; i < 8; i++) {
-		/* Set data pin to byte state */
-		if ((bytes >> (7-i)) & 0x01)
-			PORT_LCD |= (1 << LCD_DIN);
-		else
-			PORT_LCD &= ~(1 << LCD_DIN);
-
-		/* Blink clock */
-		PORT_LCD |= (1 << LCD_CLK);
-		PORT_LCD &= ~(1 << LCD_CLK);
-	}
+	shift(bytes);
 
 	/* Disable controller */
-	PORT_LCD |= (1 << LCD_SCE);
-}
-
-static void write_cmd(uint8_t cmd)
-{
-	write(cmd, 0);
+	deselect(lcd);
 }
 
-static void write_data(uint8_t data)
+static void write_cmd(const nokia_lcd_t *lcd, uint8_t cmd)
 {
-	write(data, 1);
+	write(lcd, cmd, 0);
 }
 
 /*
  * Public functions
  */
 
-void nokia_lcd_init(void)
+static pt_t reset_pt;
+static uint8_t reset_wait;
+
+/* A protothread (pt.h): no switch statements in here */
+uint8_t nokia_bus_init_Tick(void)
 {
-	register unsigned i;
-	/* Set pins as output */
-	DDR_LCD |= (1 << LCD_SCE);
-	DDR_LCD |= (1 << LCD_RST);
-	DDR_LCD |= (1 << LCD_DC);
-	DDR_LCD |= (1 << LCD_DIN);
-	DDR_LCD |= (1 << LCD_CLK);
-
-	/* Reset display */
-	PORT_LCD |= (1 << LCD_RST);
-	PORT_LCD |= (1 << LCD_SCE);
-	_delay_ms(10);
-	PORT_LCD &= ~(1 << LCD_RST);
-	_delay_ms(70);
-	PORT_LCD |= (1 << LCD_RST);
+	PT_BEGIN(&reset_pt);
+	/* Set shared pins as output */
+	PIN_OUTPUT(LCD_RST_PIN);
+	PIN_OUTPUT(LCD_DC_PIN);
+	PIN_OUTPUT(LCD_DIN_PIN);
+	PIN_OUTPUT(LCD_CLK_PIN);
+#ifdef NOKIA_USART
+	/* USART1 as SPI master, mode 0, MSB first, fosc/2 (UBRR must be 0 while TX is enabled) */
+	UBRR1 = 0;
+	UCSR1C = (1 << UMSEL11) | (1 << UMSEL10);
+	UCSR1B = (1 << TXEN1);
+	UBRR1 = 0;
+#else
+	/* SS too (see nokia5110.h) */
+	PIN_OUTPUT(LCD_SS_PIN);
+	/* SPI master, mode 0, fosc/2 (4 MHz, the PCD8544's limit) */
+	SPCR = (1 << SPE) | (1 << MSTR);
+	SPSR = (1 << SPI2X);
+#endif
+	/* Reset every display on the bus */
+	PIN_HIGH(LCD_RST_PIN);
+	PT_DELAY(&reset_pt, reset_wait, 10);
+	PIN_LOW(LCD_RST_PIN);
+	PT_DELAY(&reset_pt, reset_wait, 70);
+	PIN_HIGH(LCD_RST_PIN);
+	PT_YIELD(&reset_pt); /* a tick out of reset before the panels are set up */
+	PT_END(&reset_pt);
+}
+
+void nokia_lcd_init(nokia_lcd_t *lcd, uint8_t sce, uint8_t priority)
+{
+	lcd->cursor_x = 0;
+	lcd->cursor_y = 0;
+	lcd->font = NOKIA_FONT_FIXED;
+	lcd->sce = sce;
+	lcd->priority = priority;
+	lcd->dirty = 0;
+	lcd->sending = 0;
+	lcd->flush_pos = 0;
+	lcd->frames = 0;
+	if (panel_count < NOKIA_MAX_PANELS)
+		panels[panel_count++] = lcd;
+
+	/* Chip-select pin as output, controller deselected */
+	if (sce == LCD_SCE2)
+		PIN_OUTPUT(LCD_SCE2_PIN);
+	else
+		PIN_OUTPUT(LCD_SCE_PIN);
+	deselect(lcd);
 
 	/*
 	 * Initialize display
 	 */
-	/* Enable controller */
-	PORT_LCD &= ~(1 << LCD_SCE);
 	/* -LCD Extended Commands mode- */
-	write_cmd(0x21);
+	write_cmd(lcd, 0x21);
 	/* LCD bias mode 1:48 */
-	write_cmd(0x13);
+	write_cmd(lcd, 0x13);
 	/* Set temperature coefficient */
-	write_cmd(0x06);
+	write_cmd(lcd, 0x06);
 	/* Default VOP (3.06 + 66 * 0.06 = 7V) */
-	write_cmd(0xC2);
+	write_cmd(lcd, 0xC2);
 	/* Standard Commands mode, powered down */
-	write_cmd(0x20);
+	write_cmd(lcd, 0x20);
 	/* LCD in normal mode */
-	write_cmd(0x09);
+	write_cmd(lcd, 0x09);
+	write_cmd(lcd, 0x80);
+	write_cmd(lcd, LCD_CONTRAST);
 
-	/* Clear LCD RAM */
-	write_cmd(0x80);
-	write_cmd(LCD_CONTRAST);
-	for (i = 0; i < 504; i++)
-		write_data(0x00);
+	/* Display blank until the first frame is on the glass */
+	write_cmd(lcd, 0x08);
+	lcd->blank = 1;
 
-	/* Activate LCD */
-	write_cmd(0x08);
-	write_cmd(0x0C);
+	/* Clear LCD RAM through the arbiter instead of 504 blocking writes */
+	nokia_lcd_clear(lcd);
+	nokia_lcd_flush(lcd);
 }
 
-void nokia_lcd_clear(void)
+/* Frame fully sent: count it and switch the display on after the first one */
+static void frame_done(nokia_lcd_t *lcd)
+{
+	lcd->sending = 0;
+	lcd->frames++;
+	if (lcd->blank) {
+		write_cmd(lcd, 0x0C);
+		lcd->blank = 0;
+	}
+}
+
+/* Glyph of a character in flash, and its width in columns */
+static const uint8_t *glyph(uint8_t font, char code, uint8_t *width)
+{
+	if (code < 0x20 || code > 0x7f)
+		code = '?';
+	if (font == NOKIA_FONT_PROP) {
+		uint16_t start = pgm_read_word(&PROP_OFFSET[code - PROP_FIRST]);
+		*width = pgm_read_word(&PROP_OFFSET[code - PROP_FIRST + 1]) - start;
+		return &PROP_GLYPHS[start];
+	}
+	*width = 5;
+	return CHARSET[code - 32];
+}
+
+/* Cursor past the right edge wraps to the next text line; 1 when it did */
+static uint8_t wrap(nokia_lcd_t *lcd, uint8_t scale)
+{
+	uint8_t wrapped = 0;
+
+	if (lcd->cursor_x >= 84) {
+		lcd->cursor_x = 0;
+		lcd->cursor_y += 7*scale + 1;
+		wrapped = 1;
+	}
+	if (lcd->cursor_y >= 48) {
+		lcd->cursor_x = 0;
+		lcd->cursor_y = 0;
+	}
+	return wrapped;
+}
+
+#ifdef NOKIA_STREAM
+/*
+ * Streaming renderer
+ * Drawing appends items; the flush walks the screen bank by bank, left to
+ * right, and asks every item covering the position for its byte. Text
+ * items keep a glyph pointer and column, so each byte costs a flash read
+ * and no per-pixel work.
+ */
+static nokia_item_t *add_item(nokia_lcd_t *lcd, uint8_t kind)
+{
+	nokia_item_t *it;
+
+	if (lcd->item_count == NOKIA_MAX_ITEMS)
+		return 0;
+	it = &lcd->items[lcd->item_count++];
+	it->data = 0;
+	it->kind = kind;
+	it->x = lcd->cursor_x;
+	it->width = 0;
+	it->bank = lcd->cursor_y >> 3;
+	it->banks = 1;
+	it->len = 0;
+	it->font = lcd->font;
+	it->code = 0;
+	it->col = 0;
+	it->glyph_width = 0;
+	it->next = 0;
+	return it;
+}
+
+/*
+ * Glyph runs: a PROGMEM string, or a single character when str is NULL.
+ * The cursor moves as write_char would; a run ends where the text wraps
+ * and the rest starts a new item on the next line.
+ */
+static void add_text(nokia_lcd_t *lcd, const char *str, char code)
+{
+	nokia_item_t *it = 0;
+	uint8_t width;
+	char c;
+
+	for (;;) {
+		c = str ? pgm_read_byte(str) : code;
+		if (str && !c)
+			break;
+		if (!it) {
+			it = add_item(lcd, NOKIA_ITEM_TEXT);
+			if (!it)
+				return;
+			it->data = (const uint8_t *)str;
+			it->code = code;
+		}
+		glyph(lcd->font, c, &width);
+		lcd->cursor_x += width + 1;
+		it->len++;
+		it->width = (lcd->cursor_x < 84 ? lcd->cursor_x : 84) - it->x;
+		if (wrap(lcd, 1))
+			it = 0;
+		if (!str)
+			break;
+		str++;
+	}
+}
+
+/* Load the next character of a run */
+static void text_glyph(nokia_item_t *it)
+{
+	char c = it->data ? pgm_read_byte(it->data + it->next) : it->code;
+
+	it->next++;
+	it->col = 0;
+	it->glyph = glyph(it->font, c, &it->glyph_width);
+}
+
+/* Byte of a run at column x, called for each x of the run in order */
+static uint8_t text_byte(nokia_item_t *it, uint8_t x)
+{
+	uint8_t out = 0x00; /* spacing column */
+
+	if (x == it->x) {
+		it->next = 0;
+		text_glyph(it);
+	}
+	if (it->col < it->glyph_width)
+		out = pgm_read_byte(it->glyph + it->col);
+	if (++it->col > it->glyph_width && it->next < it->len)
+		text_glyph(it);
+	return out;
+}
+
+/* Next byte of the frame, from whatever items cover its position */
+static uint8_t stream_byte(nokia_lcd_t *lcd)
+{
+	uint8_t x = lcd->stream_x, bank = lcd->stream_bank;
+	uint8_t out = 0x00;
+	nokia_item_t *it;
+
+	for (it = lcd->items; it < &lcd->items[lcd->item_count]; it++) {
+		if (x < it->x || x >= it->x + it->width
+				|| bank < it->bank || bank >= it->bank + it->banks)
+			continue;
+		if (it->kind == NOKIA_ITEM_BITMAP)
+			out = pgm_read_byte(it->data + (bank - it->bank) * it->len + (x - it->x));
+		else
+			out = text_byte(it, x);
+	}
+	if (++lcd->stream_x == 84) {
+		lcd->stream_x = 0;
+		lcd->stream_bank++;
+	}
+	return out;
+}
+
+#define next_byte(lcd) stream_byte(lcd)
+#else
+#define next_byte(lcd) ((lcd)->screen[(lcd)->flush_pos])
+#endif
+
+/* Set column and row to 0, the frame is sent from its first byte */
+static void frame_start(nokia_lcd_t *lcd)
+{
+	write_cmd(lcd, 0x80);
+	write_cmd(lcd, 0x40);
+	lcd->flush_pos = 0;
+#ifdef NOKIA_STREAM
+	lcd->stream_x = 0;
+	lcd->stream_bank = 0;
+#endif
+}
+
+/*
+ * Send count frame bytes from flush_pos on. The next byte is fetched
+ * (or generated) while the bus shifts out the current one.
+ */
+static void send(nokia_lcd_t *lcd, uint16_t count)
+{
+	uint8_t byte;
+
+	if (!count)
+		return;
+	select(lcd);
+	PIN_HIGH(LCD_DC_PIN);
+	byte = next_byte(lcd);
+	for (;;) {
+		bus_write(byte);
+		lcd->flush_pos++;
+		if (!--count)
+			break;
+		byte = next_byte(lcd);
+		bus_ready();
+	}
+	bus_done();
+	deselect(lcd);
+}
+
+void nokia_lcd_clear(nokia_lcd_t *lcd)
 {
-	register unsigned i;
-	/* Set column and row to 0 */
-	write_cmd(0x80);
-	write_cmd(0x40);
 	/*Cursor too */
-	nokia_lcd.cursor_x = 0;
-	nokia_lcd.cursor_y = 0;
+	lcd->cursor_x = 0;
+	lcd->cursor_y = 0;
+#ifdef NOKIA_STREAM
+	/* Nothing drawn: every streamed byte is 0 */
+	lcd->item_count = 0;
+#else
+	register unsigned i;
 	/* Clear everything (504 bytes = 84cols * 48 rows / 8 bits) */
 	for(i = 0;i < 504; i++)
-		nokia_lcd.screen[i] = 0x00;
+		lcd->screen[i] = 0x00;
+#endif
 }
 
-// void nokia_lcd_power(uint8_t on)
-// {
-// 	write_cmd(on ? 0x20 : 0x24);
-// }
+void nokia_lcd_power(nokia_lcd_t *lcd, uint8_t on)
+{
+	write_cmd(lcd, on ? 0x20 : 0x24);
+}
 
-void nokia_lcd_set_pixel(uint8_t x, uint8_t y, uint8_t value)
+#ifndef NOKIA_STREAM
+void nokia_lcd_set_pixel(nokia_lcd_t *lcd, uint8_t x, uint8_t y, uint8_t value)
 {
-	uint8_t *byte = &nokia_lcd.screen[y/8*84+x];
+	uint8_t *byte = &lcd->screen[y/8*84+x];
 	if (value)
 		*byte |= (1 << (y % 8));
 	else
 		*byte &= ~(1 << (y %8 ));
 }
 
-// void nokia_lcd_write_char(char code, uint8_t scale)
-// {
-// 	register uint8_t x, y;
+/*
+ * Glyph column at (x, y), any y and any scale.
+ * Walks down the column with a bank pointer and a bit mask,
+ * so there is no divide or set_pixel call per pixel.
+ */
+static void write_column(nokia_lcd_t *lcd, uint8_t x, uint8_t y, uint8_t bits, uint8_t scale)
+{
+	uint8_t *byte = &lcd->screen[(y >> 3) * 84 + x];
+	uint8_t mask = 1 << (y & 7);
+	register uint8_t row, rep;
 
-// 	for (x = 0; x < 5*scale; x++)
-// 		for (y = 0; y < 7*scale; y++)
-// 			if (pgm_read_byte(&CHARSET[code-32][x/scale]) & (1 << y/scale))
-// 				nokia_lcd_set_pixel(nokia_lcd.cursor_x + x, nokia_lcd.cursor_y + y, 1);
-// 			else
-// 				nokia_lcd_set_pixel(nokia_lcd.cursor_x + x, nokia_lcd.cursor_y + y, 0);
+	for (row = 0; row < 7; row++) {
+		for (rep = 0; rep < scale; rep++) {
+			if (y >= 48)
+				return;
+			if (bits & 0x01)
+				*byte |= mask;
+			else
+				*byte &= ~mask;
+			y++;
+			mask <<= 1;
+			if (!mask) {
+				mask = 0x01;
+				byte += 84;
+			}
+		}
+		bits >>= 1;
+	}
+}
+#endif
 
-// 	nokia_lcd.cursor_x += 5*scale + 1;
-// 	if (nokia_lcd.cursor_x >= 84) {
-// 		nokia_lcd.cursor_x = 0;
-// 		nokia_lcd.cursor_y += 7*scale + 1;
-// 	}
-// 	if (nokia_lcd.cursor_y >= 48) {
-// 		nokia_lcd.cursor_x = 0;
-// 		nokia_lcd.cursor_y = 0;
-// 	}
-// }
+void nokia_lcd_set_font(nokia_lcd_t *lcd, uint8_t font)
+{
+	lcd->font = font;
+}
 
-// void nokia_lcd_write_string(const char *str, uint8_t scale)
-// {
-// 	while(*str)
-// 		nokia_lcd_write_char(*str++, scale);
-// }
+void nokia_lcd_write_char(nokia_lcd_t *lcd, char code, uint8_t scale)
+{
+#ifdef NOKIA_STREAM
+	/* Streamed text is always scale 1 */
+	add_text(lcd, 0, code);
+#else
+	const uint8_t *bits;
+	uint8_t width, x, y;
+	register uint8_t i, rep;
 
-void nokia_lcd_set_cursor(uint8_t x, uint8_t y)
+	bits = glyph(lcd->font, code, &width);
+	x = lcd->cursor_x;
+	y = lcd->cursor_y;
+	if (scale == 1 && (y & 7) == 0) {
+		/* Byte-aligned: glyph columns go straight from flash into the bank */
+		uint8_t *byte = &lcd->screen[(y >> 3) * 84 + x];
+		for (i = 0; i < width && x < 84; i++, x++)
+			*byte++ = pgm_read_byte(bits + i);
+		/* Spacing column */
+		if (x < 84)
+			*byte = 0x00;
+	} else {
+		for (i = 0; i < width; i++) {
+			uint8_t column = pgm_read_byte(bits + i);
+			for (rep = 0; rep < scale && x < 84; rep++, x++)
+				write_column(lcd, x, y, column, scale);
+		}
+	}
+
+	lcd->cursor_x += width * scale + 1;
+	wrap(lcd, scale);
+#endif
+}
+
+void nokia_lcd_write_string(nokia_lcd_t *lcd, const char *str, uint8_t scale)
 {
-	nokia_lcd.cursor_x = x;
-	nokia_lcd.cursor_y = y;
+	while(*str)
+		nokia_lcd_write_char(lcd, *str++, scale);
 }
 
-void nokia_lcd_render(void)
+void nokia_lcd_write_string_P(nokia_lcd_t *lcd, const char *str, uint8_t scale)
 {
-	register unsigned i;
-	/* Set column and row to 0 */
-	write_cmd(0x80);
-	write_cmd(0x40);
+#ifdef NOKIA_STREAM
+	add_text(lcd, str, 0);
+#else
+	char c;
+	while((c = pgm_read_byte(str++)))
+		nokia_lcd_write_char(lcd, c, scale);
+#endif
+}
 
+void nokia_lcd_set_cursor(nokia_lcd_t *lcd, uint8_t x, uint8_t y)
+{
+	/* Off the screen: the drawing code indexes screen[] from the cursor */
+	if (x >= 84 || y >= 48)
+		return;
+	lcd->cursor_x = x;
+	lcd->cursor_y = y;
+}
+
+void nokia_lcd_render(nokia_lcd_t *lcd)
+{
 	/* Write screen to display */
-	for (i = 0; i < 504; i++)
-		write_data(nokia_lcd.screen[i]);
+	frame_start(lcd);
+	send(lcd, 504);
+	/* Anything queued for the arbiter is now on the glass */
+	lcd->dirty = 0;
+	frame_done(lcd);
 }
 
+void nokia_lcd_flush(nokia_lcd_t *lcd)
+{
+	lcd->dirty = 1;
+}
+
+uint8_t nokia_bus_busy(void)
+{
+	register uint8_t i;
+
+	for (i = 0; i < panel_count; i++)
+		if (panels[i]->dirty || panels[i]->sending)
+			return 1;
+	return 0;
+}
+
+/*
+ * Bus arbiter
+ * Each call moves at most NOKIA_BUS_CHUNK bytes of one frame buffer.
+ * The highest priority panel with a pending or unfinished flush wins;
+ * on a tie the panel already mid-transfer keeps the bus. A panel that is
+ * pre-empted keeps its flush_pos, and since every PCD8544 keeps its own
+ * address counter the transfer simply resumes later.
+ */
+void nokia_bus_Tick(void)
+{
+	nokia_lcd_t *lcd = 0;
+	register uint8_t i;
+
+	for (i = 0; i < panel_count; i++) {
+		nokia_lcd_t *p = panels[i];
+		if (!p->dirty && !p->sending)
+			continue;
+		if (!lcd || p->priority > lcd->priority
+				|| (p->priority == lcd->priority && p->sending && !lcd->sending))
+			lcd = p;
+	}
+	if (!lcd)
+		return;
+
+	if (!lcd->sending) {
+		lcd->dirty = 0;
+		lcd->sending = 1;
+		frame_start(lcd);
+	}
+
+	send(lcd, 504 - lcd->flush_pos < NOKIA_BUS_CHUNK ? 504 - lcd->flush_pos : NOKIA_BUS_CHUNK);
+
+	if (lcd->flush_pos >= 504)
+		frame_done(lcd);
+}
+
+#ifndef NOKIA_STREAM
 // setBitMap
-void nokia_lcd_write_bitmap(const unsigned char bitMap[]) {
-	unsigned int offset = nokia_lcd.cursor_x;
+void nokia_lcd_write_bitmap(nokia_lcd_t *lcd, const unsigned char bitMap[]) {
+	unsigned int offset = lcd->cursor_x;
 	for(int i = 0; i < 288; i++) {
 		if(i < 48) 
-			nokia_lcd.screen[i + offset] = bitMap[i];
+			lcd->screen[i + offset] = bitMap[i];
 		else if(i > 48 && i <= 96)
-			nokia_lcd.screen[i+36+ offset] = bitMap[i];
+			lcd->screen[i+36+ offset] = bitMap[i];
 		else if(i > 96 && i <= 144)
-			nokia_lcd.screen[i+72+ offset] = bitMap[i];
+			lcd->screen[i+72+ offset] = bitMap[i];
 		else if(i > 144 && i <= 192)
-			nokia_lcd.screen[i+108+ offset] = bitMap[i];
+			lcd->screen[i+108+ offset] = bitMap[i];
 		else if(i > 192 && i <= 240)
-			nokia_lcd.screen[i+144+ offset] = bitMap[i];
+			lcd->screen[i+144+ offset] = bitMap[i];
 		else if(i > 240)
-			nokia_lcd.screen[i+180+ offset] = bitMap[i];
+			lcd->screen[i+180+ offset] = bitMap[i];
 	}
 }
+
+#endif
+
+void nokia_lcd_write_bitmap_P(nokia_lcd_t *lcd, const uint8_t *bitmap, uint8_t width, uint8_t banks)
+{
+#ifdef NOKIA_STREAM
+	nokia_item_t *it = add_item(lcd, NOKIA_ITEM_BITMAP);
+
+	if (!it || lcd->cursor_x >= 84 || it->bank >= 6)
+		return;
+	it->data = bitmap;
+	it->len = width;
+	it->width = width < 84 - lcd->cursor_x ? width : 84 - lcd->cursor_x;
+	it->banks = banks < 6 - it->bank ? banks : 6 - it->bank;
+#else
+	uint8_t *row = &lcd->screen[(lcd->cursor_y >> 3) * 84 + lcd->cursor_x];
+	register uint8_t x, bank;
+
+	for (bank = 0; bank < banks && row < &lcd->screen[504]; bank++) {
+		for (x = 0; x < width && lcd->cursor_x + x < 84; x++)
+			row[x] = pgm_read_byte(bitmap + x);
+		bitmap += width;
+		row += 84;
+	}
+#endif
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifdef TEMP_ONEWIRE
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+#include "onewire.h"
+#include "pins.h"
+
+#define DQ_PIN PORTA, 7
+
+#define SKIP_ROM        0xCC
+#define CONVERT_T       0x44
+#define READ_SCRATCHPAD 0xBE
+#define SCRATCHPAD      9 // bytes, the last one is the CRC
+
+// Timing in Timer2 counts (us). Compares are counted from the previous
+// match, so ISR latency shifts a slot but doesn't stretch its timed parts
+// -- except a write 0, whose release is a compare of its own and comes
+// late by however long another ISR keeps interrupts off. Those are short:
+// the Timer1 tick runs its foreground tier with interrupts on (timer.h),
+// which keeps the low time inside tLOW0 (60-120 us) and the presence
+// sample inside the window.
+#define START_DELAY  20  // first compare after onewire_start
+#define RESET_HALF   240 // reset low, two compares (480 us)
+#define PRESENCE_AT  70  // presence sample after the release
+#define RESET_REST   205 // two compares, the rest of the 480 us presence window
+#define SLOT         70
+#define WRITE0_LOW   60
+#define RECOVERY     15  // after a 0; longer than the ISR takes to set OCR2A
+#define SAMPLE_AT    12  // read sample from the falling edge, must be < 15
+
+volatile unsigned char onewireErrors = 0;
+
+static volatile unsigned char status = ONEWIRE_IDLE;
+static unsigned char tx[2];
+static unsigned char rx[SCRATCHPAD];
+static unsigned char slots; // slots in this transaction, writes first
+static unsigned char slot;  // next slot
+static unsigned char txSlots;
+
+// ISR phases of a transaction
+enum onewire_phases {ow_reset, ow_resetHold, ow_release, ow_presence, ow_rest, ow_slot, ow_write0};
+static unsigned char phase;
+
+void onewire_init(void) {
+    PRR0 &= ~(1 << PRTIM2);
+    TCCR2B = 0;             // stopped between transactions
+    TCCR2A = (1 << WGM21);  // CTC on OCR2A
+    PIN_LOW(DQ_PIN);        // only ever driven low
+    PIN_INPUT(DQ_PIN);      // released
+}
+
+static unsigned char onewire_start(unsigned char command, unsigned char rxBytes) {
+    unsigned char i;
+
+    if(status == ONEWIRE_BUSY)
+        return 0;
+    tx[0] = SKIP_ROM;
+    tx[1] = command;
+    txSlots = 16;
+    slots = txSlots + rxBytes * 8;
+    for(i = 0; i < SCRATCHPAD; i++)
+        rx[i] = 0;
+    slot = 0;
+    phase = ow_reset;
+    status = ONEWIRE_BUSY;
+
+    PRR0 &= ~(1 << PRTIM2); // power_sleep restores PRR0, but be sure
+    TCNT2 = 0;
+    OCR2A = START_DELAY - 1;
+    TIFR2 = (1 << OCF2A);
+    TIMSK2 = (1 << OCIE2A);
+    TCCR2B = (1 << CS21);   // fosc/8: 1 us per count
+    return 1;
+}
+
+unsigned char onewire_convert(void) {
+    return onewire_start(CONVERT_T, 0);
+}
+
+unsigned char onewire_read(void) {
+    return onewire_start(READ_SCRATCHPAD, SCRATCHPAD);
+}
+
+unsigned char onewire_status(void) {
+    return status;
+}
+
+// The CRC passes on an all-zero scratchpad (DQ stuck low), so check the
+// config register's fixed ones too; 85.0 C is the power-on value that a
+// read before the first conversion returns
+static unsigned char onewire_valid(void) {
+    unsigned char crc = 0;
+    unsigned char i;
+
+    for(i = 0; i < SCRATCHPAD; i++)
+        crc = _crc_ibutton_update(crc, rx[i]);
+    return crc == 0 && (rx[4] & 0x1F) == 0x1F && !(rx[0] == 0x50 && rx[1] == 0x05);
+}
+
+static void onewire_finish(unsigned char result) {
+    PIN_INPUT(DQ_PIN);
+    TIMSK2 = 0;
+    TCCR2B = 0;
+    if(result == ONEWIRE_DONE && slots > txSlots && !onewire_valid())
+        result = ONEWIRE_BAD_CRC;
+    if(result != ONEWIRE_DONE)
+        onewireErrors++;
+    status = result;
+}
+
+// One reset phase or time slot per compare
+ISR(TIMER2_COMPA_vect) {
+    unsigned char t0;
+    unsigned char n;
+
+    switch(phase) {
+        case ow_reset:
+            PIN_OUTPUT(DQ_PIN);
+            OCR2A = RESET_HALF - 1;
+            phase = ow_resetHold;
+            break;
+        case ow_resetHold:
+            phase = ow_release; // low for another RESET_HALF
+            break;
+        case ow_release:
+            PIN_INPUT(DQ_PIN);
+            OCR2A = PRESENCE_AT - 1;
+            phase = ow_presence;
+            break;
+        case ow_presence:
+            if(PIN_IS_HIGH(DQ_PIN)) {
+                onewire_finish(ONEWIRE_NO_DEVICE);
+                break;
+            }
+            OCR2A = RESET_REST - 1;
+            phase = ow_rest;
+            break;
+        case ow_rest:
+            phase = ow_slot; // another RESET_REST
+            break;
+        case ow_slot:
+            if(slot == slots) {
+                onewire_finish(ONEWIRE_DONE);
+                break;
+            }
+            n = slot++;
+            if(n < txSlots && !(tx[n >> 3] & (1 << (n & 7)))) {
+                // write 0: low for WRITE0_LOW
+                PIN_OUTPUT(DQ_PIN);
+                OCR2A = WRITE0_LOW - 1;
+                phase = ow_write0;
+                break;
+            }
+            // write 1 or read: a 1-2 us low pulse, timed on TCNT2 (the next
+            // compare is set first so it can't match during the wait)
+            OCR2A = SLOT - 1;
+            PIN_OUTPUT(DQ_PIN);
+            t0 = TCNT2;
+            while((unsigned char)(TCNT2 - t0) < 2) {}
+            PIN_INPUT(DQ_PIN);
+            if(n < txSlots)
+                break;
+            n -= txSlots;
+            while((unsigned char)(TCNT2 - t0) < SAMPLE_AT) {}
+            if(PIN_IS_HIGH(DQ_PIN))
+                rx[n >> 3] |= (1 << (n & 7)); // LSB first
+            break;
+        case ow_write0:
+            PIN_INPUT(DQ_PIN);
+            OCR2A = RECOVERY - 1;
+            phase = ow_slot;
+            break;
+        default:
+            onewire_finish(ONEWIRE_NO_DEVICE);
+            break;
+    }
+}
+
+/*
+ * Zone temp units: the top 8 bits of the ADC reading the thermistor
+ * build takes on PA7 (10k NTC, beta 3950, from AVCC; 10k to ground; the
+ * virtual board's model), every 5 C from -40 C to 125 C. Thresholds saved
+ * by either build mean the same temperature in the other.
+ */
+#define UNITS_FROM (-40 * 16) // 1/16 C, as the sensor reports
+#define UNITS_STEP (5 * 16)
+#define UNITS_COUNT 34
+
+static const unsigned char unitsTable[UNITS_COUNT] PROGMEM = {
+      6,   8,  12,  16,  22,  29,  37,  47,  58,  71,  84,  99,
+    113, 128, 141, 155, 167, 178, 188, 197, 205, 211, 217, 222,
+    227, 230, 234, 236, 239, 241, 243, 244, 245, 247
+};
+
+unsigned char onewire_sample(void) {
+    int16_t raw = (int16_t)(((uint16_t)rx[1] << 8) | rx[0]);
+    unsigned char i, lo, hi, frac;
+
+    if(raw <= UNITS_FROM)
+        return pgm_read_byte(&unitsTable[0]);
+    if(raw >= UNITS_FROM + (UNITS_COUNT - 1) * UNITS_STEP)
+        return pgm_read_byte(&unitsTable[UNITS_COUNT - 1]);
+    raw -= UNITS_FROM;
+    i = raw / UNITS_STEP;
+    frac = raw % UNITS_STEP;
+    lo = pgm_read_byte(&unitsTable[i]);
+    hi = pgm_read_byte(&unitsTable[i + 1]);
+    return lo + (unsigned char)(((unsigned int)(hi - lo) * frac) / UNITS_STEP);
+}
+
+#endif
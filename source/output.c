@@ -0,0 +1,29 @@
+#include <avr/io.h>
+#include "output.h"
+#include "pins.h"
+
+volatile unsigned char outShadow[OUT_PORTS];
+static unsigned char outWritten[OUT_PORTS]; // shadow as last committed
+
+void out_init(void) {
+    outShadow[OUT_A] = outWritten[OUT_A] = PORTA & OUT_MASK_A;
+    outShadow[OUT_D] = outWritten[OUT_D] = PORTD & OUT_MASK_D;
+}
+
+// A macro so the port stays a constant: in/andi/or/out, not a pointer
+#define out_port(port, mask, i) do { \
+    unsigned char value = outShadow[i]; \
+    unsigned char sreg; \
+    if(value != outWritten[i]) { \
+        sreg = SREG; \
+        __asm__ __volatile__ ("cli" ::: "memory"); \
+        PORT_WRITE(port, (PORT_READ(port) & ~(mask)) | value); \
+        SREG = sreg; \
+        outWritten[i] = value; \
+    } \
+} while(0)
+
+void out_commit(void) {
+    out_port(PORTA, OUT_MASK_A, OUT_A);
+    out_port(PORTD, OUT_MASK_D, OUT_D);
+}
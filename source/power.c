@@ -0,0 +1,79 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include "power.h"
+#include "ticks.h"
+
+volatile unsigned char powerWake = POWER_WAKE_NONE;
+unsigned long powerWakeLatency = 0;
+
+static volatile unsigned long wakeStamp = 0;
+static unsigned char measuring = 0;
+
+void power_init(void) {
+    // TWI, USART1, Timer0/2/3 (the SPI drives the Nokia bus)
+#ifdef TEMP_ONEWIRE
+    // Timer2 runs the 1-Wire slots (onewire.c) and the ADC isn't used
+    PRR0 = (1 << PRTWI) | (1 << PRUSART1) | (1 << PRTIM0) | (1 << PRADC);
+#else
+    PRR0 = (1 << PRTWI) | (1 << PRUSART1) | (1 << PRTIM0) | (1 << PRTIM2);
+#endif
+    PRR1 = (1 << PRTIM3);
+    // zone_init() takes back the timers of zones 1-3 (zone.h)
+}
+
+unsigned char power_sleep(unsigned char wdt) {
+    unsigned char prr = PRR0;
+    unsigned char adcsra = ADCSRA;
+
+    ADCSRA &= ~(1 << ADEN); // ADC must be off before it can be gated
+    PRR0 |= (1 << PRADC) | (1 << PRUSART0);
+
+    cli();
+    if(wdt) {
+        // watchdog in interrupt-only mode, ~8 s period. The second store
+        // must follow the first within 4 cycles, which -O0 C doesn't
+        // guarantee: both values are in registers before the first sts.
+        wdt_reset();
+        __asm__ __volatile__ (
+            "sts %0, %1" "\n\t"
+            "sts %0, %2" "\n\t"
+            :: "n" (_SFR_MEM_ADDR(WDTCSR)),
+               "r" ((unsigned char)((1 << WDCE) | (1 << WDE))),
+               "r" ((unsigned char)((1 << WDIE) | (1 << WDP3) | (1 << WDP0)))
+            : "memory");
+    }
+    powerWake = POWER_WAKE_NONE;
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sei(); // executes the next instruction before any interrupt
+    sleep_cpu();
+    sleep_disable();
+
+    wdt_disable();
+    PRR0 = prr;
+    ADCSRA = adcsra;
+    if(powerWake == POWER_WAKE_PIN)
+        measuring = 1;
+    return powerWake;
+}
+
+void power_responsive(void) {
+    if(measuring) {
+        powerWakeLatency = (ticks_now() - wakeStamp) * TICKS_US;
+        measuring = 0;
+    }
+}
+
+void power_pinWake(void) {
+    if(powerWake == POWER_WAKE_NONE) {
+        wakeStamp = ticks_now();
+        powerWake = POWER_WAKE_PIN;
+    }
+}
+
+ISR(WDT_vect) {
+    if(powerWake == POWER_WAKE_NONE)
+        powerWake = POWER_WAKE_WDT;
+}
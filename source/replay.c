@@ -0,0 +1,87 @@
+#ifdef REPLAY
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "replay.h"
+#include "input.h"
+#include "power.h"
+#include "ticks.h"
+#include "replaytrace.h" // generated by tools/replay.py: replayTrace[], REPLAY_RECORDS
+
+volatile unsigned char replayAdc = 0;
+volatile unsigned char replayDone = 0;
+
+static unsigned short replayPos = 0;
+static unsigned short replayDue = 0;       // ms until replayTrace[replayPos]
+static unsigned char replayStarted = 0;
+static unsigned char replayPins = 0xFF;    // PINA as replayed: released, IR idle
+
+// NEC frame timing, 8 us counts (input.c accepts +-0.4 ms)
+#define NEC_START 1688 // 13.5 ms
+#define NEC_ZERO  141  // 1.125 ms
+#define NEC_ONE   281  // 2.25 ms
+#define NEC_MARK  70   // 560 us burst
+
+// One IR frame as receiver edges, stamped ahead of now: the decoder only
+// looks at the time between falling edges
+static void replay_ir(unsigned long code) {
+    unsigned long t = ticks_now();
+    unsigned char i;
+
+    input_pins(replayPins & ~INPUT_IR, t);
+    input_pins(replayPins, t + NEC_MARK);
+    t += NEC_START;
+    for(i = 0; i <= 32; i++) {
+        input_pins(replayPins & ~INPUT_IR, t);
+        input_pins(replayPins, t + NEC_MARK);
+        if(i < 32)
+            t += (code & (0x80000000UL >> i)) ? NEC_ONE : NEC_ZERO;
+    }
+}
+
+static void replay_apply(const replay_record_t *r) {
+    switch(r->kind) {
+        case REPLAY_PINA:
+            replayPins = (replayPins & ~INPUT_BUTTONS) | (r->value & INPUT_BUTTONS);
+            power_pinWake();
+            input_pins(replayPins, ticks_now());
+            break;
+        case REPLAY_IR:
+            power_pinWake();
+            replay_ir(r->value);
+            break;
+        case REPLAY_ADC:
+            replayAdc = r->value;
+            break;
+        default:
+            break;
+    }
+}
+
+void replay_Tick(void) {
+    replay_record_t r;
+
+    if(replayDone)
+        return;
+    if(!replayStarted) {
+        replayStarted = 1;
+        replayDue = pgm_read_word(&replayTrace[0].dt);
+    }
+    if(replayDue > 1) {
+        replayDue--;
+        return;
+    }
+    for(;;) { // every record due in this millisecond
+        memcpy_P(&r, &replayTrace[replayPos], sizeof(r));
+        replay_apply(&r);
+        if(++replayPos == REPLAY_RECORDS) {
+            replayDone = 1;
+            return;
+        }
+        replayDue = pgm_read_word(&replayTrace[replayPos].dt);
+        if(replayDue != 0)
+            return;
+    }
+}
+
+#endif
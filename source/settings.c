@@ -0,0 +1,94 @@
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "settings.h"
+
+static settings_t ring[SETTINGS_SLOTS] EEMEM;
+
+static settings_t stored;     // copy of the newest record in EEPROM
+static settings_t pending;    // record being staged / written
+static unsigned char head = SETTINGS_SLOTS - 1; // slot of the newest record
+static unsigned short quiet = 0;  // ms since the last change to pending
+static unsigned char staged = 0;  // pending differs from stored
+static unsigned char writePos = 0xFF; // next byte of pending to write, 0xFF idle
+
+static unsigned char settings_crc(const settings_t *s) {
+    const unsigned char *p = (const unsigned char *)s;
+    unsigned char crc = 0x00;
+    unsigned char i;
+
+    for(i = 0; i < sizeof(settings_t) - 1; i++)
+        crc = _crc8_ccitt_update(crc, p[i]);
+    return crc;
+}
+
+// Same user-visible settings (seq, version and crc aside)
+static unsigned char settings_equal(const settings_t *a, const settings_t *b) {
+    return a->fanOn == b->fanOn && a->pos_speed == b->pos_speed
+        && a->oscillateOn == b->oscillateOn && a->tempMode == b->tempMode
+        && a->tempThreshold == b->tempThreshold;
+}
+
+unsigned char settings_load(settings_t *s) {
+    settings_t r;
+    unsigned char i;
+    unsigned char found = 0;
+
+    for(i = 0; i < SETTINGS_SLOTS; i++) {
+        eeprom_read_block(&r, &ring[i], sizeof(settings_t));
+        if(r.version != SETTINGS_VERSION || r.crc != settings_crc(&r))
+            continue;
+        // live sequence numbers span at most SETTINGS_SLOTS, so a signed
+        // difference orders them across the 255 -> 0 wrap
+        if(!found || (signed char)(r.seq - stored.seq) > 0) {
+            stored = r;
+            head = i;
+            found = 1;
+        }
+    }
+    if(found)
+        *s = stored;
+    else
+        stored.seq = 0xFF; // first record written will be seq 0 in slot 0
+    return found;
+}
+
+void settings_save(const settings_t *s) {
+    const settings_t *ref = staged ? &pending : &stored;
+
+    if(settings_equal(s, ref))
+        return;
+    if(writePos != 0xFF) // record in flight, restage once it's done
+        return;
+    pending = *s;
+    quiet = 0;
+    staged = !settings_equal(&pending, &stored);
+}
+
+void settings_Tick(void) {
+    unsigned char slot;
+
+    if(writePos == 0xFF) {
+        if(!staged || ++quiet < SETTINGS_QUIET_MS)
+            return;
+        pending.seq = stored.seq + 1;
+        pending.version = SETTINGS_VERSION;
+        pending.crc = settings_crc(&pending);
+        writePos = 0;
+    }
+    if(!eeprom_is_ready())
+        return;
+
+    slot = (head + 1) % SETTINGS_SLOTS;
+    eeprom_update_byte((unsigned char *)&ring[slot] + writePos, ((unsigned char *)&pending)[writePos]);
+    if(++writePos == sizeof(settings_t)) {
+        stored = pending;
+        head = slot;
+        staged = 0;
+        writePos = 0xFF;
+    }
+}
+
+unsigned char settings_busy(void) {
+    return staged || writePos != 0xFF;
+}
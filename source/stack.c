@@ -0,0 +1,65 @@
+#include <avr/io.h>
+#include "stack.h"
+
+extern uint8_t _end;    // end of .bss, provided by the linker
+extern uint8_t __stack; // top of RAM, provided by the linker
+
+volatile uint16_t stackFree = 0;
+volatile uint16_t stackSize = 0;
+
+static uint8_t *scan = &_end;
+
+/*
+ * Runs from .init1, before SP and the zero register are set up, so it can't
+ * use any locals. Plain asm loop: Z = _end; while (Z <= __stack) *Z++ = canary;
+ */
+void stack_paint(void) __attribute__ ((naked, used, section(".init1")));
+void stack_paint(void)
+{
+    __asm volatile (
+        "    ldi r30, lo8(_end)\n"
+        "    ldi r31, hi8(_end)\n"
+        "    ldi r24, %0\n"
+        "    ldi r25, hi8(__stack)\n"
+        "    rjmp 2f\n"
+        "1:  st Z+, r24\n"
+        "2:  cpi r30, lo8(__stack)\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :
+        : "i" (STACK_CANARY)
+    );
+}
+
+uint16_t stack_unused(void)
+{
+    const uint8_t *p = &_end;
+    uint16_t count = 0;
+
+    while (p <= &__stack && *p == STACK_CANARY) {
+        p++;
+        count++;
+    }
+    return count;
+}
+
+void stack_Tick(void)
+{
+    unsigned char i;
+
+    if (stackSize == 0) {
+        stackSize = (uint16_t)(&__stack - &_end) + 1;
+        stackFree = stackSize;
+    }
+    for (i = 0; i < STACK_SCAN_CHUNK; i++) {
+        if (scan > &__stack || *scan != STACK_CANARY) {
+            // first byte the stack has touched, restart the scan from the bottom
+            if ((uint16_t)(scan - &_end) < stackFree)
+                stackFree = (uint16_t)(scan - &_end);
+            scan = &_end;
+            return;
+        }
+        scan++;
+    }
+}
@@ -0,0 +1,88 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "pins.h"
+#include "tach.h"
+#include "ticks.h"
+
+volatile unsigned short tachRpm = 0;
+volatile unsigned long tachPeriod = 0;
+
+static volatile unsigned long lastEdge = 0;
+static volatile unsigned long periods[TACH_AVG];
+static volatile unsigned char periodPos = 0;
+static volatile unsigned char periodCount = 0; // valid entries in periods[]
+
+void tach_init(void) {
+    // runs after TimerOn(): sbi/cbi only, out_commit() owns PORTD (output.h)
+    PIN_INPUT(PORTD, 6);
+    PIN_HIGH(PORTD, 6);                     // open-collector tach, pull-up
+    TCCR1B |= (1 << ICNC1);                 // noise canceler, falling edge
+    TIFR1 = (1 << ICF1);
+    TIMSK1 |= (1 << ICIE1);
+}
+
+void tach_capture(unsigned long stamp) {
+    unsigned long period = stamp - lastEdge;
+
+    lastEdge = stamp;
+    if(period > (unsigned long)TACH_STALL_MS * TICKS_PER_MS) {
+        // first edge after a stop, no period yet
+        periodCount = 0;
+        return;
+    }
+    periods[periodPos] = period;
+    periodPos = (periodPos + 1) & (TACH_AVG - 1);
+    if(periodCount < TACH_AVG)
+        periodCount++;
+}
+
+void tach_Tick(void) {
+    unsigned long sum = 0;
+    unsigned char count, i;
+
+    cli();
+    if(ticks_at(TCNT1) - lastEdge > (unsigned long)TACH_STALL_MS * TICKS_PER_MS)
+        periodCount = 0;
+    count = periodCount;
+    for(i = 0; i < count; i++)
+        sum += periods[i];
+    sei();
+
+    if(count == 0) {
+        tachPeriod = 0;
+        tachRpm = 0;
+        return;
+    }
+    tachPeriod = sum / count;
+    // rpm = 60 s / (period * 8 us * pulses per rev)
+    tachRpm = (60000000UL / TICKS_US / TACH_PULSES) / tachPeriod;
+}
+
+ISR(TIMER1_CAPT_vect) {
+    tach_capture(ticks_at(ICR1));
+}
+
+#ifdef TACH_SIM
+unsigned char tachSimLoad = 100;
+static unsigned long simRpm = 0;    // model speed, rpm << 8
+static unsigned long simPhase = 0;  // rpm * pulses accumulated per ms
+
+void tach_simTick(unsigned char motorEnable) {
+    unsigned long target = motorEnable ? ((unsigned long)TACH_SIM_MAX_RPM * tachSimLoad / 100) << 8 : 0;
+
+    // first-order rotor inertia, time constant ~256 ms: averages the PWM
+    if(target > simRpm)
+        simRpm += (target - simRpm) >> 8;
+    else
+        simRpm -= (simRpm - target) >> 8;
+
+    // one edge every 60000 / (rpm * pulses) ms
+    simPhase += (simRpm >> 8) * TACH_PULSES;
+    if(simPhase >= 60000UL) {
+        simPhase -= 60000UL;
+        cli();
+        tach_capture(ticks_at(TCNT1));
+        sei();
+    }
+}
+#endif
@@ -0,0 +1,208 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include "uart.h"
+#include "bus.h"
+#include "pins.h"
+
+#ifndef F_CPU
+#define F_CPU 8000000UL
+#endif
+
+volatile unsigned char uartDropped = 0;
+volatile unsigned char uartRxErrors = 0;
+
+static unsigned char txBuf[UART_TX_SIZE];
+static volatile unsigned char txHead = 0; // written by tasks
+static volatile unsigned char txTail = 0; // written by the UDRE ISR
+static volatile unsigned char txUsed = 0; // anything sent since uart_init
+
+static uart_frame_t rxFrames[UART_RX_FRAMES];
+static volatile unsigned char rxHead = 0; // written by the RX ISR
+static volatile unsigned char rxTail = 0; // written by uart_recvFrame()
+
+// RX parser state (ISR only)
+enum uart_rxStates {rx_sync1, rx_sync2, rx_len, rx_type, rx_payload, rx_crc};
+static unsigned char rxState = rx_sync1;
+static unsigned char rxPos = 0;
+static unsigned char rxCrc = 0;
+static unsigned char rxLen = 0;
+static unsigned char rxType = 0;
+static unsigned char rxKeep = 0;  // a slot was free when the frame started
+
+#define uart_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+void uart_init(void) {
+    UBRR0 = F_CPU / 8 / UART_BAUD - 1; // 25 -> 38462 baud, 0.2% error
+    UCSR0A = (1 << U2X0);
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // 8N1
+#ifdef BUS_NODE
+    UCSR0B = (1 << TXEN0) | (1 << RXEN0) | (1 << RXCIE0) | (1 << TXCIE0);
+#else
+    UCSR0B = (1 << TXEN0) | (1 << RXEN0) | (1 << RXCIE0);
+#endif
+}
+
+unsigned char uart_txFree(void) {
+    return UART_TX_SIZE - (unsigned char)(txHead - txTail);
+}
+
+// Caller has checked for room
+static void uart_queue(unsigned char c) {
+    unsigned char head = txHead;
+    txBuf[head & (UART_TX_SIZE - 1)] = c;
+    uart_barrier();
+    txHead = head + 1;
+}
+
+static void uart_kick(void) {
+#ifdef BUS_NODE
+    PIN_HIGH(BUS_DE_PIN); // on the bus before the first start bit
+#endif
+    UCSR0B |= (1 << UDRIE0);
+}
+
+unsigned char uart_putc(unsigned char c) {
+    if(uart_txFree() == 0) {
+        uartDropped++;
+        return 0;
+    }
+    uart_queue(c);
+    uart_kick();
+    return 1;
+}
+
+unsigned char uart_sendFrame(unsigned char type, const void *payload, unsigned char len) {
+    const unsigned char *p = (const unsigned char *)payload;
+    unsigned char crc;
+    unsigned char i;
+
+    if(uart_txFree() < len + UART_FRAME_OVERHEAD) {
+        uartDropped++;
+        return 0;
+    }
+    uart_queue(UART_SYNC1);
+    uart_queue(UART_SYNC2);
+    uart_queue(len);
+    uart_queue(type);
+    crc = _crc8_ccitt_update(0x00, len);
+    crc = _crc8_ccitt_update(crc, type);
+    for(i = 0; i < len; i++) {
+        uart_queue(p[i]);
+        crc = _crc8_ccitt_update(crc, p[i]);
+    }
+    uart_queue(crc);
+    uart_kick();
+    return 1;
+}
+
+unsigned char uart_idle(void) {
+#ifdef BUS_NODE
+    // the TX complete ISR takes TXC0 and lets go of the bus
+    return txHead == txTail && !PIN_IS_HIGH(BUS_DE_PIN);
+#else
+    // TXC0 is only meaningful once a byte has gone out
+    return txHead == txTail && (!txUsed || (UCSR0A & (1 << TXC0)));
+#endif
+}
+
+ISR(USART0_UDRE_vect) {
+    unsigned char tail = txTail;
+    if(tail == txHead) {
+        UCSR0B &= ~(1 << UDRIE0); // ring empty
+        return;
+    }
+    UCSR0A = (1 << U2X0) | (1 << TXC0); // clear "transmit complete" for uart_idle
+    txUsed = 1;
+    UDR0 = txBuf[tail & (UART_TX_SIZE - 1)];
+    txTail = tail + 1;
+}
+
+#ifdef BUS_NODE
+// Last stop bit out with nothing queued behind it: off the bus, so the
+// next node can answer
+ISR(USART0_TX_vect) {
+    if(txHead == txTail)
+        PIN_LOW(BUS_DE_PIN);
+}
+#endif
+
+unsigned char uart_recvFrame(uart_frame_t *f) {
+    unsigned char tail = rxTail;
+    if(tail == rxHead)
+        return 0;
+    *f = rxFrames[tail & (UART_RX_FRAMES - 1)];
+    uart_barrier(); // slot copied before it is handed back
+    rxTail = tail + 1;
+    return 1;
+}
+
+unsigned char uart_rxBusy(void) {
+    return rxState != rx_sync1 || rxHead != rxTail;
+}
+
+ISR(USART0_RX_vect) {
+    unsigned char status = UCSR0A;
+    unsigned char c = UDR0;
+    uart_frame_t *f = &rxFrames[rxHead & (UART_RX_FRAMES - 1)];
+
+    if(status & ((1 << FE0) | (1 << DOR0))) {
+        uartRxErrors++;
+        rxState = rx_sync1;
+        return;
+    }
+    switch(rxState) {
+        case rx_sync1:
+            if(c == UART_SYNC1)
+                rxState = rx_sync2;
+            break;
+        case rx_sync2:
+            if(c == UART_SYNC2)
+                rxState = rx_len;
+            else if(c != UART_SYNC1)
+                rxState = rx_sync1;
+            break;
+        case rx_len:
+            if(c > UART_RX_MAX) {
+                uartRxErrors++;
+                rxState = rx_sync1;
+                break;
+            }
+            rxLen = c;
+            rxCrc = _crc8_ccitt_update(0x00, c);
+            rxState = rx_type;
+            break;
+        case rx_type:
+            rxType = c;
+            rxCrc = _crc8_ccitt_update(rxCrc, c);
+            rxPos = 0;
+            rxKeep = (unsigned char)(rxHead - rxTail) < UART_RX_FRAMES;
+            rxState = rxLen ? rx_payload : rx_crc;
+            break;
+        case rx_payload:
+            if(rxKeep)
+                f->payload[rxPos] = c;
+            rxCrc = _crc8_ccitt_update(rxCrc, c);
+            if(++rxPos == rxLen)
+                rxState = rx_crc;
+            break;
+        case rx_crc:
+            rxState = rx_sync1;
+            if(c != rxCrc) {
+                uartRxErrors++;
+                break;
+            }
+            if(!rxKeep) {
+                uartDropped++; // ring was full
+                break;
+            }
+            f->type = rxType;
+            f->len = rxLen;
+            uart_barrier(); // slot contents before the new head
+            rxHead++;
+            break;
+        default:
+            rxState = rx_sync1;
+            break;
+    }
+}
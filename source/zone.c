@@ -0,0 +1,88 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "zone.h"
+#include "pins.h"
+
+#if ZONES > 1
+
+#define ZONE3_PIN PORTC, 0
+
+void zone_init(void) {
+    // fast PWM, TOP 0xFF, fosc/64; outputs connected by zone_pwm
+    PRR0 &= ~(1 << PRTIM0);
+    OCR0B = 0;
+    TCCR0A = (1 << WGM01) | (1 << WGM00);
+    TCCR0B = (1 << CS01) | (1 << CS00);
+#if ZONES > 2
+    PRR0 &= ~(1 << PRTIM2);
+    OCR2A = 0;
+    TCCR2A = (1 << WGM21) | (1 << WGM20);
+    TCCR2B = (1 << CS22);
+#endif
+#if ZONES > 3
+    PRR1 &= ~(1 << PRTIM3);
+    PIN_LOW(ZONE3_PIN);
+    PIN_OUTPUT(ZONE3_PIN);
+    OCR3A = 0;
+    TCCR3A = (1 << WGM30);               // fast PWM 8-bit
+    TCCR3B = (1 << WGM32) | (1 << CS31) | (1 << CS30);
+#endif
+}
+
+void zone_pwm(unsigned char z, unsigned char duty) {
+    switch(z) {
+        case 1:
+            OCR0B = duty;
+            if(duty)
+                TCCR0A |= (1 << COM0B1);
+            else
+                TCCR0A &= ~(1 << COM0B1); // PORTB4 is 0
+            break;
+#if ZONES > 2
+        case 2:
+            OCR2A = duty;
+            if(duty)
+                TCCR2A |= (1 << COM2A1);
+            else
+                TCCR2A &= ~(1 << COM2A1); // PORTD7 is 0
+            break;
+#endif
+#if ZONES > 3
+        case 3:
+            OCR3A = duty;
+            if(duty) {
+                TIMSK3 = (1 << TOIE3) | (1 << OCIE3A);
+            } else {
+                TIMSK3 = 0;
+                PIN_LOW(ZONE3_PIN);
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+#if ZONES > 3
+// Zone 3: high from BOTTOM to the compare. A pulse whose compare went by
+// before the overflow ISR got to run (another ISR in the way) is skipped,
+// rather than left high for a whole period.
+ISR(TIMER3_OVF_vect) {
+    if(TCNT3 < OCR3A)
+        PIN_HIGH(ZONE3_PIN);
+}
+
+ISR(TIMER3_COMPA_vect) {
+    PIN_LOW(ZONE3_PIN);
+}
+#endif
+
+#else
+
+void zone_init(void) {
+}
+
+void zone_pwm(unsigned char z, unsigned char duty) {
+}
+
+#endif
@@ -7,6 +7,7 @@ import logging
 logging.basicConfig(level=logging.INFO)
 gdbLogger = logging.getLogger(name='GDB Logger')
 resultsFN = 'build/results/test_out.txt'
+boardFN = 'build/results/board_state.txt' # written by the virtual board (make boardtest)
 
 def report(msg,*args,**kwargs):
     with open(resultsFN,'a') as f:
@@ -46,6 +47,11 @@ class AVR:
     ports = { 'PORTA': 0x22, 'PORTB': 0x25, 'PORTC': 0x28, 'PORTD': 0x2B }
     registers = [pins,ddrs,ports]
     endian = 'big' #?
+    ramend = 0x40FF # data space: registers, I/O, SRAM
+    eeprom = 0x810000 # simavr's gdb address of the EEPROM
+    eepromSize = 0x1000
+    # Boot is over when both background bring-up tasks are done (main.c)
+    bootDone = 'b1_state == b1_done && b2_state == b2_done'
     def __init__(self,inf,while1,period=None):
         self.inferior = inf
         self.period = period
@@ -54,6 +60,7 @@ class AVR:
         #self.bp.commands = '\n'.join(['silent']) #TODO: Verbosity?
         self.bp.enabled = True
         self.watchList = []
+        self.saved = None
 
     def __str__(self):
         return self.inferior.architecture().name()
@@ -73,6 +80,55 @@ class AVR:
             gdbLogger.warning(f'No known period, running for 1 iterations instead of {n} ms')
             self.runForNIterations(1)
 
+    def runUntil(self,condition):
+        # Run to the first pass of the main loop where condition holds
+        self.bp.condition = condition
+        gdb.execute(f'continue')
+        self.bp.condition = None
+
+    def snapshot(self):
+        # Full state at a stop: data space (r0-r31, I/O, SRAM with the stack
+        # and its canary paint), EEPROM (settings, history) and the core
+        # registers that live outside the data space
+        self.saved = {
+            'memory': [(addr,self.inferior.read_memory(addr,size).tobytes())
+                for addr,size in ((self.base,self.ramend+1),(self.eeprom,self.eepromSize))],
+            'registers': [(reg,int(gdb.parse_and_eval(f'${reg}'))) for reg in ('SREG','SP','pc')],
+        }
+        gdbLogger.info(f'Snapshot taken at pc {hex(self.saved["registers"][2][1])}')
+
+    def restore(self):
+        # Back to the snapshot. Reading the state back is one transfer per
+        # region, so only the runs of bytes that differ are written. The
+        # peripherals' internal state (timer phase, UART FIFOs, a conversion
+        # in progress) and the virtual board's models are not part of it.
+        if not self.saved:
+            return False
+        start = time.perf_counter()
+        written = 0
+        for addr,saved in self.saved['memory']:
+            now = self.inferior.read_memory(addr,len(saved)).tobytes()
+            for lo,hi in self._changed(saved,now):
+                self.inferior.write_memory(addr+lo,saved[lo:hi])
+                written += hi-lo
+        for reg,value in self.saved['registers']:
+            gdb.execute(f'set ${reg} = {value}')
+        gdb.execute('flushregs',to_string=True) # r0-r31 were written as memory
+        gdbLogger.debug(f'Restored {written} bytes in {(time.perf_counter()-start)*1000:.1f} ms')
+        return True
+
+    @staticmethod
+    def _changed(a,b,gap=8):
+        # (lo,hi) runs where a and b differ, joined across gaps of up to gap bytes
+        runs = []
+        blocks = (c for c in range(0,len(a),64) if a[c:c+64] != b[c:c+64])
+        for i in (i for c in blocks for i in range(c,min(c+64,len(a))) if a[i] != b[i]):
+            if runs and i-runs[-1][1] <= gap:
+                runs[-1][1] = i+1
+            else:
+                runs.append([i,i+1])
+        return runs
+
     def runUntilPinChange(self,port,mask=0xFF):
         if port in self.pinMapping:
             mask = self.pinMapping[port][1]
@@ -161,7 +217,25 @@ class AVR:
         self.inferior.write_memory(self.base+self.pins[port],buff,1)
         return True
 
+    def readBoard(self,key):
+        # Model state from the virtual board, e.g. board.hd44780.row0
+        try:
+            with open(boardFN) as f:
+                state = dict(line.rstrip('\n').split('=',1) for line in f if '=' in line)
+        except OSError:
+            gdbLogger.warning(f'No board state in {boardFN}, is the test running on the virtual board?')
+            return None
+        value = state.get(key)
+        for kind in (int,float):
+            try:
+                return kind(value)
+            except (TypeError,ValueError):
+                pass
+        return value
+
     def read(self,var):
+        if var.startswith('board.'):
+            return self.readBoard(var[len('board.'):])
         # Handle pin mapping
         symbol = gdb.lookup_symbol(var)[0]
         if symbol and symbol.is_valid():
@@ -186,6 +260,25 @@ class displayChip(gdb.Command):
     def invoke(self,arg,tty):
         self.avr.display()
 
+class snapshotChip(gdb.Command):
+    '''Save the AVR state, restored before each isolated test and by restoreChip
+    Taken automatically once the firmware has booted
+    '''
+    def __init__(self,avr):
+        super(snapshotChip,self).__init__('snapshotChip',gdb.COMMAND_USER)
+        self.avr = avr
+    def invoke(self,arg,tty):
+        self.avr.snapshot()
+
+class restoreChip(gdb.Command):
+    '''Return the AVR to the last snapshotChip state'''
+    def __init__(self,avr):
+        super(restoreChip,self).__init__('restoreChip',gdb.COMMAND_USER)
+        self.avr = avr
+    def invoke(self,arg,tty):
+        if not self.avr.restore():
+            print('No snapshot, use snapshotChip first')
+
 class runTests(gdb.Command):
     '''Run user defined tests
     Usage: runTests [N]
@@ -215,6 +308,8 @@ class runTests(gdb.Command):
         if self.i < len(self.tests):
             report('='*50)
             report(f'Test {self.i+1}: \"{self.tests[self.i].description}\"...',end='')
+            if self.tests[self.i].isolated:
+                self.tests[self.i].program.restore()
             passed,message = self.tests[self.i].run()
             report(message)
             self.passed += 1 if passed else 0
@@ -229,8 +324,9 @@ class runTests(gdb.Command):
             self._report()
 
 class Test():
-    def __init__(self,program,description,steps,expected,preconditions=None,skip=False):
+    def __init__(self,program,description,steps,expected,preconditions=None,skip=False,isolated=True):
         self.description = description
+        self.isolated = isolated
         self.preconditions = preconditions
         self.program = program
         self.steps = steps
@@ -305,6 +401,9 @@ if sync:
     capturePeriod = SyncCatch(avr)
     gdb.execute('continue')
 gdb.execute('continue')
+# Every isolated test starts from here instead of a fresh boot
+avr.runUntil(globals().get('boot',AVR.bootDone))
+avr.snapshot()
 
 if 'pinMapping' in globals():
     avr.mapPins(pinMapping)
@@ -313,4 +412,6 @@ if 'watch' in globals():
         avr.addWatch(watchVariable)
 runTests(tests)
 displayChip(avr)
+snapshotChip(avr)
+restoreChip(avr)
 #avr.bp.commands = 'displayChip\n' # Uncomment if you'd like to see the chip displayed at every break
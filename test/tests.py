@@ -11,14 +11,19 @@
 #           If this value is incorrect the test will fail early before completing.
 #       * only one of these should be used
 #   expected - The expected output (as a list of tuples) at the end of this test
-# An example set of tests is shown below. It is important to note that these tests are not "unit tests" in 
-# that they are not ran in isolation but in the order shown and the state of the device is not reset or 
-# altered in between executions (unless preconditions are used).
+#   isolated - (default True) start from the state the device was in right after boot
+# An example set of tests is shown below. Tests run in the order shown. The runner takes a snapshot of
+# the device (registers, SRAM, I/O registers and EEPROM) once the firmware has booted and restores it
+# before each test, so every test starts from the same state without waiting for a reboot. A test
+# with 'isolated': False carries on from the state the previous test left instead.
+# The timers' phase, the UART buffers and the virtual board's models (board.<key>) are not part of the
+# snapshot; give a test expecting a board value enough time for the firmware to redraw.
 tests = [ {'description': 'This test will run first.',
     'steps': [ {'inputs': [('PINA',<val>)], 'iterations': 1 } ],
     'expected': [('PORT',<val>)],
     },
-    {'description': 'This test will run second.',
+    {'description': 'This test will run second, from where the first one left off.',
+    'isolated': False,
     'steps': [ {'inputs': [('PIN', <val>)],'iterations': 1}, # Set PIN to val then run one iteration
         {'inputs': [('PIN',<val>)], 'time': 300 }, # Set PIN to val then run 300 ms
         {'inputs': [('PIN',<val>)], 'iterations': 1, 'expected': [('PORT',<val>)]}, 
@@ -27,8 +32,17 @@ tests = [ {'description': 'This test will run first.',
     },
     ]
 
+# Under "make boardtest" (virtual board) an expected entry can also name the state of a
+# modelled part as board.<key>, e.g. ('board.hd44780.row0', 'Pwr:On  Osc:Off '),
+# ('board.servo.angle', 180), ('board.lcdfan.mode', 'normal').
+# The keys are listed in tools/board/board.c.
+
 # Optionally you can add a set of "watch" variables these need to be global or static and may need
 # to be scoped at the function level (for static variables) if there are naming conflicts. The 
 # variables listed here will display everytime you hit (and stop at) a breakpoint
 watch = ['<function>::<static-var>','PORTB']
 
+# Optionally the condition (a gdb expression, checked at the top of the main loop) that ends the boot
+# and is snapshotted for the isolated tests. The default waits for both displays to be brought up.
+# boot = 'b1_state == b1_done && b2_state == b2_done'
+
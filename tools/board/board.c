@@ -0,0 +1,383 @@
+/*
+ * Virtual board: the firmware under simavr with models of the parts wired
+ * to it, so tests can check what the displays show and what the fan does
+ * instead of raw port bits.
+ *
+ * Usage: board [-g [port]] [--state FILE] [--png DIR] [--temp C]
+ *              [--temp-at MS:C ...] [--ms N] [--profile FILE [--profile-every N]]
+ *              [--display display.elf] [--pty LINK] firmware.elf
+ *
+ *   -g          wait for gdb on port 1234 (or the given port), like simavr -g
+ *   --state     where the model state is kept up to date, one "key=value"
+ *               per line (default build/results/board_state.txt); test
+ *               expectations on "board.<key>" read it (testRunner.py)
+ *   --png       write every frame of both Nokia displays as a PNG into DIR
+ *   --temp      room temperature at the thermistor (default 22 C)
+ *   --temp-at   change the temperature at MS ms of simulated time
+ *   --ms        stop after N ms of simulated time
+ *   --profile   sample the PC and the call stack into FILE (profile.h)
+ *   --profile-every
+ *               cycles between samples (default 997: prime, so the samples
+ *               don't lock onto the 1 ms tick)
+ *   --display   split build (header/link.h): run display.elf on a second
+ *               core that owns the Nokia displays, fed by firmware.elf's
+ *               SPI while its PB0 is low; gdb, --profile and the other
+ *               parts stay on firmware.elf
+ *   --pty       USART0 on a new pseudo terminal, LINK a symlink to it (a
+ *               fan bus node, bus.h: tools/fanbus.py joins several). Also
+ *               holds simulated time to wall time, so boards on one bus
+ *               keep step; a slower host just runs behind.
+ *
+ * State keys:
+ *   lcdfan.* / lcdstatus.*  on, mode (blank/all_on/normal/inverse), frames, lit
+ *   hd44780.*               on, row0, row1 (16 characters each)
+ *   motor.*                 duty (0-1, ~50 ms average), rpm (negative backwards)
+ *   servo.*                 pulse_us, angle (degrees), pulses
+ *   thermistor.*            celsius, mv
+ *
+ * Wiring (see main.c, io.h, nokia5110.h):
+ *   PB0-PB3  two PCD8544 (SCE PB1 fan animation, PB0 status; RST, DC), data
+ *            from the SPI module (MOSI PB5, SCK PB7)
+ *   PORTC    HD44780 data, RS on PB4, E on PD7
+ *   PD3      motor enable (PWM), PD4/PD5 direction
+ *   PD2      servo
+ *   ADC7     thermistor divider
+ *
+ * In the split build the Nokia displays hang off the display core instead:
+ * SCE PB1/PB0, RST PB2, DC PB3, data from USART1 (master SPI mode, which
+ * simavr runs as a plain UART -- the bytes are the same, only slower).
+ *
+ * The tach input isn't driven: build with make TACHSIM=1 to feed the capture
+ * path from the firmware's own motor model (tach.c).
+ */
+#include <fcntl.h>
+#include <getopt.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_gdb.h"
+#include "sim_time.h"
+#include "sim_cycle_timers.h"
+#include "avr_ioport.h"
+#include "avr_spi.h"
+#include "avr_uart.h"
+#include "pcd8544.h"
+#include "hd44780.h"
+#include "motor.h"
+#include "servo.h"
+#include "thermistor.h"
+#include "profile.h"
+
+#define BOARD_STATE_MS 1 // state file refresh, simulated time
+#define BOARD_STATE_SIZE 2048
+#define BOARD_PROFILE_EVERY 997 // cycles
+#define BOARD_PTY_US 100 // pty polled for input, simulated time
+
+static avr_t *avr;
+static avr_t *display; // split build only
+static int linkSelected = 0; // control PB0 low
+static pcd8544_t lcdFan, lcdStatus;
+static hd44780_t lcdText;
+static motor_t motor;
+static servo_t servo;
+static thermistor_t thermistor;
+static profile_t profile;
+static int ptyFd = -1;
+static int ptyXoff = 0; // USART0's receive FIFO is full
+static struct timespec wallStart;
+
+static const char *statePath = "build/results/board_state.txt";
+static char stateShown[BOARD_STATE_SIZE];
+static volatile sig_atomic_t quit = 0;
+
+static int board_pcd8544(char *p, int n, const char *key, const pcd8544_t *lcd) {
+    static const char *modes[] = {"blank", "all_on", "normal", "inverse"};
+
+    return snprintf(p, n, "%s.on=%d\n%s.mode=%s\n%s.frames=%lu\n%s.lit=%d\n",
+            key, !lcd->powerDown, key, modes[lcd->mode & 3], key, lcd->frames, key, pcd8544_lit(lcd));
+}
+
+static void board_state(int force) {
+    char state[BOARD_STATE_SIZE], tmp[512], row0[HD44780_COLS + 1], row1[HD44780_COLS + 1];
+    int n = 0;
+    FILE *f;
+
+    hd44780_row(&lcdText, 0, row0);
+    hd44780_row(&lcdText, 1, row1);
+    n += board_pcd8544(state + n, sizeof(state) - n, "lcdfan", &lcdFan);
+    n += board_pcd8544(state + n, sizeof(state) - n, "lcdstatus", &lcdStatus);
+    n += snprintf(state + n, sizeof(state) - n,
+            "hd44780.on=%d\nhd44780.row0=%s\nhd44780.row1=%s\n"
+            "motor.duty=%.2f\nmotor.rpm=%.0f\n"
+            "servo.pulse_us=%u\nservo.angle=%.0f\nservo.pulses=%lu\n"
+            "thermistor.celsius=%.1f\nthermistor.mv=%u\n",
+            lcdText.displayOn, row0, row1,
+            motor.duty, motor.rpm,
+            servo.pulseUs, servo.angle, servo.pulses,
+            thermistor.celsius, thermistor.mv);
+    if(!force && strcmp(state, stateShown) == 0)
+        return;
+    strcpy(stateShown, state);
+
+    // write and rename, so a reader never sees half a file
+    snprintf(tmp, sizeof(tmp), "%s.tmp", statePath);
+    f = fopen(tmp, "w");
+    if(!f)
+        return;
+    fprintf(f, "time_ms=%llu\n%s", (unsigned long long)(avr_cycles_to_usec(avr, avr->cycle) / 1000), state);
+    fclose(f);
+    rename(tmp, statePath);
+}
+
+static avr_cycle_count_t board_tick(struct avr_t *avr, avr_cycle_count_t when, void *param) {
+    board_state(0);
+    return when + avr_usec_to_cycles(avr, BOARD_STATE_MS * 1000);
+}
+
+// Split build: the control core's SPI bytes reach the display core's
+// slave while the control core holds SS (PB0) low
+static void board_linkSS(struct avr_irq_t *irq, uint32_t value, void *param) {
+    linkSelected = !value;
+}
+
+static void board_link(struct avr_irq_t *irq, uint32_t value, void *param) {
+    if(linkSelected)
+        avr_raise_irq(avr_io_getirq(display, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_INPUT), value);
+}
+
+// --pty: what USART0 sends goes to the pty, what the pty has is fed in as
+// fast as the receive FIFO takes it (simavr spaces it out at the baud rate)
+static void board_ptyOut(struct avr_irq_t *irq, uint32_t value, void *param) {
+    uint8_t c = value;
+
+    if(write(ptyFd, &c, 1) != 1) {} // nobody on the other end: the byte is lost, as on a wire
+}
+
+static void board_ptyXon(struct avr_irq_t *irq, uint32_t value, void *param) {
+    ptyXoff = 0;
+}
+
+static void board_ptyXoff(struct avr_irq_t *irq, uint32_t value, void *param) {
+    ptyXoff = 1;
+}
+
+static avr_cycle_count_t board_ptyIn(struct avr_t *avr, avr_cycle_count_t when, void *param) {
+    avr_irq_t *in = param;
+    struct timespec wall, ahead = {0, 0};
+    long long simUs, wallUs;
+    uint8_t c;
+
+    while(!ptyXoff && read(ptyFd, &c, 1) == 1)
+        avr_raise_irq(in, c);
+    // hold simulated time to wall time
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    simUs = avr_cycles_to_usec(avr, avr->cycle);
+    wallUs = (wall.tv_sec - wallStart.tv_sec) * 1000000LL + (wall.tv_nsec - wallStart.tv_nsec) / 1000;
+    if(simUs > wallUs) {
+        ahead.tv_sec = (simUs - wallUs) / 1000000;
+        ahead.tv_nsec = (simUs - wallUs) % 1000000 * 1000;
+        nanosleep(&ahead, NULL);
+    }
+    return when + avr_usec_to_cycles(avr, BOARD_PTY_US);
+}
+
+static void board_pty(const char *link) {
+    struct termios t;
+    uint32_t flags = 0;
+    char name[256];
+    int slave;
+
+    if(openpty(&ptyFd, &slave, name, NULL, NULL) != 0) {
+        perror("board: openpty");
+        exit(1);
+    }
+    tcgetattr(slave, &t);
+    cfmakeraw(&t);
+    tcsetattr(slave, TCSANOW, &t);
+    fcntl(ptyFd, F_SETFL, fcntl(ptyFd, F_GETFL) | O_NONBLOCK);
+    unlink(link);
+    if(symlink(name, link) != 0) {
+        perror("board: symlink");
+        exit(1);
+    }
+    fprintf(stderr, "board: USART0 on %s (%s)\n", name, link);
+
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO; // frames, not text
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), board_ptyOut, NULL);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XON), board_ptyXon, NULL);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XOFF), board_ptyXoff, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    avr_cycle_timer_register_usec(avr, BOARD_PTY_US, board_ptyIn,
+            avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT));
+}
+
+static avr_t *board_load(const char *path) {
+    elf_firmware_t f;
+    avr_t *core;
+
+    memset(&f, 0, sizeof(f));
+    if(elf_read_firmware(path, &f) != 0) {
+        fprintf(stderr, "board: can't load %s\n", path);
+        exit(1);
+    }
+    core = avr_make_mcu_by_name(f.mmcu[0] ? f.mmcu : "atmega1284");
+    if(!core) {
+        fprintf(stderr, "board: unknown MCU %s\n", f.mmcu);
+        exit(1);
+    }
+    if(!f.frequency)
+        f.frequency = 8000000;
+    avr_init(core);
+    avr_load_firmware(core, &f);
+    if(!core->avcc)
+        core->vcc = core->avcc = core->aref = 5000; // mV, for the ADC
+    return core;
+}
+
+static void board_quit(int sig) {
+    quit = 1;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: board [-g [port]] [--state FILE] [--png DIR] [--temp C] "
+            "[--temp-at MS:C ...] [--ms N] [--profile FILE [--profile-every N]] "
+            "[--display display.elf] [--pty LINK] firmware.elf\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option options[] = {
+        {"state", required_argument, 0, 's'},
+        {"png", required_argument, 0, 'p'},
+        {"temp", required_argument, 0, 't'},
+        {"temp-at", required_argument, 0, 'a'},
+        {"ms", required_argument, 0, 'm'},
+        {"profile", required_argument, 0, 'P'},
+        {"profile-every", required_argument, 0, 'e'},
+        {"display", required_argument, 0, 'd'},
+        {"pty", required_argument, 0, 'y'},
+        {0, 0, 0, 0},
+    };
+    const char *pngDir = NULL;
+    const char *displayPath = NULL;
+    const char *profilePath = NULL;
+    const char *ptyLink = NULL;
+    avr_cycle_count_t profileEvery = BOARD_PROFILE_EVERY;
+    double celsius = 22.0;
+    unsigned long stepMs[THERMISTOR_STEPS];
+    double stepC[THERMISTOR_STEPS];
+    int steps = 0;
+    unsigned long long runMs = 0;
+    int gdbPort = 0;
+    int opt, i, state, displayState = cpu_Running;
+
+    while((opt = getopt_long(argc, argv, "g::", options, NULL)) != -1) {
+        switch(opt) {
+            case 'g': gdbPort = optarg ? atoi(optarg) : 1234; break;
+            case 's': statePath = optarg; break;
+            case 'p': pngDir = optarg; break;
+            case 't': celsius = atof(optarg); break;
+            case 'a':
+                if(steps == THERMISTOR_STEPS || sscanf(optarg, "%lu:%lf", &stepMs[steps], &stepC[steps]) != 2)
+                    usage();
+                steps++;
+                break;
+            case 'm': runMs = strtoull(optarg, NULL, 0); break;
+            case 'P': profilePath = optarg; break;
+            case 'e': profileEvery = strtoull(optarg, NULL, 0); break;
+            case 'd': displayPath = optarg; break;
+            case 'y': ptyLink = optarg; break;
+            default: usage();
+        }
+    }
+    if(optind != argc - 1 || profileEvery == 0)
+        usage();
+
+    avr = board_load(argv[optind]);
+    if(displayPath) {
+        uint32_t flags = 0;
+        avr_irq_t *bytes;
+
+        display = board_load(displayPath);
+        bytes = avr_io_getirq(display, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_OUTPUT);
+        avr_ioctl(display, AVR_IOCTL_UART_GET_FLAGS('1'), &flags);
+        flags &= ~AVR_UART_FLAG_STDIO; // LCD bytes, not text
+        avr_ioctl(display, AVR_IOCTL_UART_SET_FLAGS('1'), &flags);
+        pcd8544_init(display, &lcdFan, "lcdfan", 'B', 1, 2, 3, -1, -1);
+        pcd8544_init(display, &lcdStatus, "lcdstatus", 'B', 0, 2, 3, -1, -1);
+        pcd8544_attach(&lcdFan, bytes);
+        pcd8544_attach(&lcdStatus, bytes);
+        avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 0), board_linkSS, NULL);
+        avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT), board_link, NULL);
+    } else {
+        avr_irq_t *bytes = avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT);
+
+        pcd8544_init(avr, &lcdFan, "lcdfan", 'B', 1, 2, 3, -1, -1);
+        pcd8544_init(avr, &lcdStatus, "lcdstatus", 'B', 0, 2, 3, -1, -1);
+        pcd8544_attach(&lcdFan, bytes);
+        pcd8544_attach(&lcdStatus, bytes);
+    }
+    lcdFan.pngDir = lcdStatus.pngDir = pngDir;
+    hd44780_init(avr, &lcdText, 'C', 'B', 4, 'D', 7);
+    motor_init(avr, &motor, 'D', 3, 4, 5, 3000, 300);
+    servo_init(avr, &servo, 'D', 2, 1000, 2000);
+    thermistor_init(avr, &thermistor, 7, celsius);
+    for(i = 0; i < steps; i++)
+        thermistor_at(&thermistor, stepMs[i], stepC[i]);
+    avr_cycle_timer_register_usec(avr, BOARD_STATE_MS * 1000, board_tick, NULL);
+    if(profilePath && profile_init(avr, &profile, profilePath, profileEvery) != 0) {
+        fprintf(stderr, "board: can't write %s\n", profilePath);
+        return 1;
+    }
+
+    if(ptyLink)
+        board_pty(ptyLink);
+
+    if(gdbPort) {
+        avr->gdb_port = gdbPort;
+        avr->state = cpu_Stopped;
+        avr_gdb_init(avr);
+    }
+    signal(SIGINT, board_quit);
+    signal(SIGTERM, board_quit);
+
+    do {
+        state = avr_run(avr);
+        // the display core follows the control core's clock
+        while(display && displayState != cpu_Done && displayState != cpu_Crashed
+                && display->cycle < avr->cycle)
+            displayState = avr_run(display);
+        if(runMs && avr_cycles_to_usec(avr, avr->cycle) / 1000 >= runMs)
+            break;
+    } while(!quit && state != cpu_Done && state != cpu_Crashed);
+    if(displayState == cpu_Crashed)
+        fprintf(stderr, "board: display core crashed\n");
+
+    board_state(1);
+    if(profilePath) {
+        fprintf(stderr, "board: %lu profile samples in %s\n", profile.samples, profilePath);
+        profile_close(&profile);
+    }
+    if(pngDir) { // last picture of each display, whatever the frame count
+        char path[512];
+        snprintf(path, sizeof(path), "%s/lcdfan_last.png", pngDir);
+        pcd8544_png(&lcdFan, path, 4);
+        snprintf(path, sizeof(path), "%s/lcdstatus_last.png", pngDir);
+        pcd8544_png(&lcdStatus, path, 4);
+    }
+    if(display)
+        avr_terminate(display);
+    avr_terminate(avr);
+    if(ptyLink)
+        unlink(ptyLink);
+    return state == cpu_Crashed || displayState == cpu_Crashed;
+}
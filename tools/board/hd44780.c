@@ -0,0 +1,110 @@
+#include <string.h>
+#include "avr_ioport.h"
+#include "hd44780.h"
+
+static void hd44780_step(hd44780_t *lcd) {
+    if(lcd->cgMode) {
+        lcd->ac = (lcd->ac + (lcd->increment ? 1 : -1)) & 0x3F;
+        return;
+    }
+    // two-line mode: DDRAM is 0x00-0x27 and 0x40-0x67
+    if(lcd->increment) {
+        lcd->ac++;
+        if(lcd->ac == 0x28)
+            lcd->ac = 0x40;
+        else if(lcd->ac == 0x68)
+            lcd->ac = 0x00;
+    } else {
+        if(lcd->ac == 0x00)
+            lcd->ac = 0x67;
+        else if(lcd->ac == 0x40)
+            lcd->ac = 0x27;
+        else
+            lcd->ac--;
+    }
+}
+
+static void hd44780_command(hd44780_t *lcd, uint8_t c) {
+    if(c & 0x80) {
+        lcd->ac = c & 0x7F;
+        lcd->cgMode = 0;
+    } else if(c & 0x40) {
+        lcd->ac = c & 0x3F;
+        lcd->cgMode = 1;
+    } else if(c & 0x20) {
+        // function set: the firmware only uses 8 bits, 2 lines
+    } else if(c & 0x10) {
+        if(!(c & 0x08)) { // cursor move (display shift isn't modelled)
+            uint8_t inc = lcd->increment;
+            lcd->increment = (c >> 2) & 1;
+            hd44780_step(lcd);
+            lcd->increment = inc;
+        }
+    } else if(c & 0x08) {
+        lcd->displayOn = (c >> 2) & 1;
+        lcd->cursorOn = (c >> 1) & 1;
+        lcd->blinkOn = c & 1;
+    } else if(c & 0x04) {
+        lcd->increment = (c >> 1) & 1;
+    } else if(c & 0x02) {
+        lcd->ac = 0;
+        lcd->cgMode = 0;
+    } else if(c & 0x01) {
+        memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+        lcd->ac = 0;
+        lcd->cgMode = 0;
+        lcd->increment = 1;
+    }
+}
+
+static void hd44780_data(struct avr_irq_t *irq, uint32_t value, void *param) {
+    hd44780_t *lcd = param;
+    lcd->data = value;
+}
+
+static void hd44780_rs(struct avr_irq_t *irq, uint32_t value, void *param) {
+    hd44780_t *lcd = param;
+    lcd->rsLevel = value ? 1 : 0;
+}
+
+static void hd44780_e(struct avr_irq_t *irq, uint32_t value, void *param) {
+    hd44780_t *lcd = param;
+    uint8_t was = lcd->eLevel;
+
+    lcd->eLevel = value ? 1 : 0;
+    if(!was || lcd->eLevel)
+        return; // latch on the falling edge only
+    if(!lcd->rsLevel) {
+        hd44780_command(lcd, lcd->data);
+        return;
+    }
+    if(lcd->cgMode)
+        lcd->cgram[lcd->ac & 0x3F] = lcd->data;
+    else
+        lcd->ddram[lcd->ac & 0x7F] = lcd->data;
+    lcd->writes++;
+    hd44780_step(lcd);
+}
+
+void hd44780_init(struct avr_t *avr, hd44780_t *lcd, char dataPort,
+        char rsPort, int rs, char ePort, int e) {
+    memset(lcd, 0, sizeof(*lcd));
+    memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+    lcd->avr = avr;
+    lcd->rs = rs;
+    lcd->e = e;
+    lcd->increment = 1;
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(dataPort), IOPORT_IRQ_PIN_ALL),
+            hd44780_data, lcd);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(rsPort), rs), hd44780_rs, lcd);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(ePort), e), hd44780_e, lcd);
+}
+
+void hd44780_row(const hd44780_t *lcd, int row, char *text) {
+    const uint8_t *ram = lcd->ddram + (row ? 0x40 : 0x00);
+    int i;
+
+    for(i = 0; i < HD44780_COLS; i++)
+        text[i] = (ram[i] >= 0x20 && ram[i] < 0x7F) ? ram[i] : '?';
+    text[HD44780_COLS] = 0;
+}
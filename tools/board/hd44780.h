@@ -0,0 +1,42 @@
+#ifndef __BOARD_HD44780_H__
+#define __BOARD_HD44780_H__
+
+#include <stdint.h>
+#include "sim_avr.h"
+
+/*
+ * HD44780 character LCD model (8-bit bus, 16x2)
+ *
+ * Latches the data port on the falling edge of E, as an instruction or as
+ * data depending on RS, and keeps the display and character generator RAM
+ * and the address counter. Busy times aren't modelled: the firmware waits
+ * them out itself (io.c), so a violation shows up on the real glass only.
+ */
+
+#define HD44780_COLS 16
+
+typedef struct {
+    struct avr_t *avr;
+    int rs, e;          // pin numbers on their ports
+    uint8_t data;       // data port as last driven
+    uint8_t rsLevel;
+    uint8_t eLevel;
+    uint8_t ddram[0x80];
+    uint8_t cgram[0x40];
+    uint8_t ac;         // address counter
+    uint8_t cgMode;     // ac points into CGRAM
+    uint8_t increment;
+    uint8_t displayOn, cursorOn, blinkOn;
+    unsigned long writes;
+} hd44780_t;
+
+void hd44780_init(struct avr_t *avr, hd44780_t *lcd, char dataPort,
+        char rsPort, int rs, char ePort, int e);
+
+/*
+ * One row of the glass as text (HD44780_COLS chars + NUL); characters
+ * outside printable ASCII show as '?'
+ */
+void hd44780_row(const hd44780_t *lcd, int row, char *text);
+
+#endif
@@ -0,0 +1,62 @@
+#include <string.h>
+#include "avr_ioport.h"
+#include "sim_time.h"
+#include "motor.h"
+
+#define MOTOR_DUTY_MS 50.0 // averaging of the reported duty
+
+static void motor_en(struct avr_irq_t *irq, uint32_t value, void *param) {
+    motor_t *m = param;
+
+    if(value && !m->enLevel)
+        m->highStart = m->avr->cycle;
+    else if(!value && m->enLevel)
+        m->highCycles += m->avr->cycle - m->highStart;
+    m->enLevel = value ? 1 : 0;
+}
+
+static void motor_dir(struct avr_irq_t *irq, uint32_t value, void *param) {
+    motor_t *m = param;
+
+    if((int)irq->irq == m->in1)
+        m->in1Level = value ? 1 : 0;
+    else
+        m->in2Level = value ? 1 : 0;
+}
+
+static avr_cycle_count_t motor_ms(struct avr_t *avr, avr_cycle_count_t when, void *param) {
+    motor_t *m = param;
+    avr_cycle_count_t ms = avr_usec_to_cycles(avr, 1000);
+    double duty, target;
+
+    if(m->enLevel) { // close the current high interval at this boundary
+        m->highCycles += avr->cycle - m->highStart;
+        m->highStart = avr->cycle;
+    }
+    duty = (double)m->highCycles / ms;
+    if(duty > 1.0)
+        duty = 1.0;
+    m->highCycles = 0;
+
+    m->duty += (duty - m->duty) / MOTOR_DUTY_MS;
+    target = 0;
+    if(m->in1Level != m->in2Level)
+        target = (m->in1Level ? 1 : -1) * duty * m->maxRpm;
+    m->rpm += (target - m->rpm) / m->tauMs;
+    return when + ms;
+}
+
+void motor_init(struct avr_t *avr, motor_t *m, char port, int en, int in1, int in2,
+        double maxRpm, double tauMs) {
+    memset(m, 0, sizeof(*m));
+    m->avr = avr;
+    m->en = en;
+    m->in1 = in1;
+    m->in2 = in2;
+    m->maxRpm = maxRpm;
+    m->tauMs = tauMs;
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), en), motor_en, m);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), in1), motor_dir, m);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), in2), motor_dir, m);
+    avr_cycle_timer_register_usec(avr, 1000, motor_ms, m);
+}
@@ -0,0 +1,34 @@
+#ifndef __BOARD_MOTOR_H__
+#define __BOARD_MOTOR_H__
+
+#include <stdint.h>
+#include "sim_avr.h"
+#include "sim_cycle_timers.h"
+
+/*
+ * DC fan motor behind an H-bridge
+ *
+ * The enable pin's high time is measured exactly (cycle stamps on each
+ * edge) and, once per millisecond, the duty of that millisecond drives a
+ * first-order model: speed moves towards duty x maxRpm with time constant
+ * tauMs. The two direction pins pick the sign (in1 high: forward, in2 high:
+ * backward, equal: brake).
+ */
+
+typedef struct {
+    struct avr_t *avr;
+    int en, in1, in2;
+    uint8_t enLevel;
+    uint8_t in1Level, in2Level;
+    avr_cycle_count_t highStart; // cycle enable last went high
+    avr_cycle_count_t highCycles; // high time in the current millisecond
+    double maxRpm;
+    double tauMs;
+    double duty;  // enable duty, averaged over about 50 ms
+    double rpm;   // signed: positive forward
+} motor_t;
+
+void motor_init(struct avr_t *avr, motor_t *m, char port, int en, int in1, int in2,
+        double maxRpm, double tauMs);
+
+#endif
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "avr_ioport.h"
+#include "pcd8544.h"
+#include "png.h"
+
+static void pcd8544_reset(pcd8544_t *lcd) {
+    lcd->powerDown = 1;
+    lcd->vertical = 0;
+    lcd->extended = 0;
+    lcd->mode = PCD8544_BLANK;
+    lcd->x = 0;
+    lcd->y = 0;
+    lcd->bits = 0;
+}
+
+static void pcd8544_command(pcd8544_t *lcd, uint8_t c) {
+    if((c & 0xF8) == 0x20) { // function set, in both instruction sets
+        lcd->powerDown = (c >> 2) & 1;
+        lcd->vertical = (c >> 1) & 1;
+        lcd->extended = c & 1;
+        return;
+    }
+    if(lcd->extended)
+        return; // temperature coefficient, bias, Vop
+    if(c & 0x80)
+        lcd->x = (c & 0x7F) < PCD8544_WIDTH ? (c & 0x7F) : 0;
+    else if(c & 0x40)
+        lcd->y = (c & 0x07) < PCD8544_BANKS ? (c & 0x07) : 0;
+    else if((c & 0xF8) == 0x08)
+        lcd->mode = ((c >> 1) & 2) | (c & 1); // D, E
+}
+
+static void pcd8544_data(pcd8544_t *lcd, uint8_t d) {
+    char path[512];
+
+    lcd->ram[lcd->y][lcd->x] = d;
+    lcd->bytes++;
+    if(lcd->vertical) {
+        if(++lcd->y == PCD8544_BANKS) {
+            lcd->y = 0;
+            if(++lcd->x == PCD8544_WIDTH)
+                lcd->x = 0;
+        }
+    } else {
+        if(++lcd->x == PCD8544_WIDTH) {
+            lcd->x = 0;
+            if(++lcd->y == PCD8544_BANKS)
+                lcd->y = 0;
+        }
+    }
+    if(lcd->x == 0 && lcd->y == 0) {
+        lcd->frames++;
+        if(lcd->pngDir) {
+            snprintf(path, sizeof(path), "%s/%s_%05lu.png", lcd->pngDir, lcd->name, lcd->frames);
+            pcd8544_png(lcd, path, 4);
+        }
+        if(lcd->onFrame)
+            lcd->onFrame(lcd);
+    }
+}
+
+static void pcd8544_byte(pcd8544_t *lcd, uint8_t b) {
+    if(lcd->pins & (1 << lcd->dc))
+        pcd8544_data(lcd, b);
+    else
+        pcd8544_command(lcd, b);
+}
+
+static void pcd8544_bytes(struct avr_irq_t *irq, uint32_t value, void *param) {
+    pcd8544_t *lcd = param;
+
+    if(!(lcd->pins & (1 << lcd->sce)) && (lcd->pins & (1 << lcd->rst)))
+        pcd8544_byte(lcd, value);
+}
+
+static void pcd8544_pin(struct avr_irq_t *irq, uint32_t value, void *param) {
+    pcd8544_t *lcd = param;
+    int n = irq->irq;
+    uint8_t pin = 1 << n;
+    uint8_t was = lcd->pins;
+
+    lcd->pins = value ? (lcd->pins | pin) : (lcd->pins & ~pin);
+    if(n == lcd->rst && !value) {
+        pcd8544_reset(lcd);
+    } else if(n == lcd->sce && value) {
+        lcd->bits = 0; // deselect aborts a partial byte
+    } else if(n == lcd->clk && value && !(was & pin)
+            && !(lcd->pins & (1 << lcd->sce)) && (lcd->pins & (1 << lcd->rst))) {
+        lcd->shift = (lcd->shift << 1) | ((lcd->pins >> lcd->din) & 1);
+        if(++lcd->bits == 8) {
+            lcd->bits = 0;
+            pcd8544_byte(lcd, lcd->shift);
+        }
+    }
+}
+
+void pcd8544_init(struct avr_t *avr, pcd8544_t *lcd, const char *name, char port,
+        int sce, int rst, int dc, int din, int clk) {
+    const int pins[5] = {sce, rst, dc, din, clk};
+    int i;
+
+    memset(lcd, 0, sizeof(*lcd));
+    lcd->avr = avr;
+    lcd->name = name;
+    lcd->sce = sce;
+    lcd->rst = rst;
+    lcd->dc = dc;
+    lcd->din = din;
+    lcd->clk = clk;
+    lcd->pins = 1 << sce; // deselected
+    pcd8544_reset(lcd);
+    for(i = 0; i < 5; i++)
+        if(pins[i] >= 0)
+            avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), pins[i]),
+                    pcd8544_pin, lcd);
+}
+
+void pcd8544_attach(pcd8544_t *lcd, struct avr_irq_t *bytes) {
+    avr_irq_register_notify(bytes, pcd8544_bytes, lcd);
+}
+
+int pcd8544_pixel(const pcd8544_t *lcd, int x, int y) {
+    int bit = (lcd->ram[y / 8][x] >> (y % 8)) & 1;
+
+    if(lcd->powerDown)
+        return 0;
+    switch(lcd->mode) {
+        case PCD8544_ALL_ON: return 1;
+        case PCD8544_NORMAL: return bit;
+        case PCD8544_INVERSE: return !bit;
+        default: return 0;
+    }
+}
+
+int pcd8544_lit(const pcd8544_t *lcd) {
+    int x, y, n = 0;
+
+    for(y = 0; y < PCD8544_HEIGHT; y++)
+        for(x = 0; x < PCD8544_WIDTH; x++)
+            n += pcd8544_pixel(lcd, x, y);
+    return n;
+}
+
+int pcd8544_png(const pcd8544_t *lcd, const char *path, int scale) {
+    int w = PCD8544_WIDTH * scale, h = PCD8544_HEIGHT * scale;
+    uint8_t *img = malloc(w * h);
+    int x, y, r;
+
+    if(!img)
+        return -1;
+    for(y = 0; y < h; y++)
+        for(x = 0; x < w; x++)
+            img[y * w + x] = pcd8544_pixel(lcd, x / scale, y / scale) ? 0x20 : 0xC8;
+    r = png_write_gray(path, w, h, img);
+    free(img);
+    return r;
+}
@@ -0,0 +1,75 @@
+#ifndef __BOARD_PCD8544_H__
+#define __BOARD_PCD8544_H__
+
+#include <stdint.h>
+#include "sim_avr.h"
+
+/*
+ * PCD8544 (Nokia 5110) model
+ *
+ * Watches the SPI lines of one port and decodes the stream the way the
+ * controller does: 8 bits shifted in on each rising CLK edge while SCE is
+ * low, D/C sampled with the last bit. With din and clk < 0 the bytes come
+ * from a peripheral instead (simavr doesn't toggle the pins of its SPI or
+ * USART), see pcd8544_attach(). Commands (basic set only --
+ * the extended set just tunes contrast and bias) move the address pointer
+ * and switch the display mode; data bytes land in the 6 x 84 display RAM.
+ *
+ * A frame is complete when the address pointer wraps back to (0, 0), which
+ * is how nokia_lcd_render()/flush() write a whole screen.
+ */
+
+#define PCD8544_WIDTH 84
+#define PCD8544_BANKS 6
+#define PCD8544_HEIGHT (PCD8544_BANKS * 8)
+
+// Display control modes (D, E bits)
+#define PCD8544_BLANK   0
+#define PCD8544_ALL_ON  1
+#define PCD8544_NORMAL  2
+#define PCD8544_INVERSE 3
+
+typedef struct pcd8544_t {
+    struct avr_t *avr;
+    const char *name;
+    int sce, rst, dc, din, clk; // pin numbers on the port, din/clk < 0 for the SPI module
+    uint8_t pins;               // last level of each pin
+    uint8_t shift;
+    uint8_t bits;
+    uint8_t powerDown;
+    uint8_t vertical;
+    uint8_t extended;
+    uint8_t mode;
+    uint8_t x, y;
+    uint8_t ram[PCD8544_BANKS][PCD8544_WIDTH];
+    unsigned long frames;    // complete frames written
+    unsigned long bytes;     // data bytes written
+    const char *pngDir;      // when set, every frame is written as <name>_<frame>.png
+    void (*onFrame)(struct pcd8544_t *lcd);
+} pcd8544_t;
+
+void pcd8544_init(struct avr_t *avr, pcd8544_t *lcd, const char *name, char port,
+        int sce, int rst, int dc, int din, int clk);
+
+/*
+ * Take whole bytes from an IRQ, e.g. the SPI or USART output of the AVR
+ * driving the display; they count while SCE is low and RST high
+ */
+void pcd8544_attach(pcd8544_t *lcd, struct avr_irq_t *bytes);
+
+/*
+ * Pixel as seen on the glass: display mode and power-down applied
+ */
+int pcd8544_pixel(const pcd8544_t *lcd, int x, int y);
+
+/*
+ * Lit pixels on the glass, a cheap fingerprint for tests
+ */
+int pcd8544_lit(const pcd8544_t *lcd);
+
+/*
+ * Write what the glass shows, scaled up, as a grayscale PNG
+ */
+int pcd8544_png(const pcd8544_t *lcd, const char *path, int scale);
+
+#endif
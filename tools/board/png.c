@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "png.h"
+
+static uint32_t crcTable[256];
+
+static void crc_init(void) {
+    uint32_t c;
+    int n, k;
+
+    if(crcTable[1])
+        return;
+    for(n = 0; n < 256; n++) {
+        c = n;
+        for(k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+        crcTable[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *p, size_t len) {
+    while(len--)
+        crc = crcTable[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t head[8];
+    uint32_t crc;
+
+    put32(head, len);
+    memcpy(head + 4, type, 4);
+    crc = crc_update(0xFFFFFFFFUL, head + 4, 4);
+    crc = crc_update(crc, data, len) ^ 0xFFFFFFFFUL;
+    fwrite(head, 1, 8, f);
+    fwrite(data, 1, len, f);
+    put32(head, crc);
+    fwrite(head, 1, 4, f);
+}
+
+int png_write_gray(const char *path, int width, int height, const uint8_t *pixels) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    size_t raw = (size_t)(width + 1) * height; // filter byte per row
+    size_t blocks = raw / 65535 + 1;
+    uint8_t *z = malloc(2 + raw + blocks * 5 + 4);
+    uint8_t ihdr[13];
+    uint32_t a = 1, b = 0; // adler32
+    size_t pos = 0, done = 0, n, i;
+    uint8_t byte;
+    FILE *f;
+
+    if(!z)
+        return -1;
+    crc_init();
+    z[pos++] = 0x78; // zlib header, no compression
+    z[pos++] = 0x01;
+    while(done < raw) {
+        n = raw - done > 65535 ? 65535 : raw - done;
+        z[pos++] = (done + n == raw); // BFINAL, BTYPE 00 (stored)
+        z[pos++] = n & 0xFF;
+        z[pos++] = n >> 8;
+        z[pos++] = ~n & 0xFF;
+        z[pos++] = (~n >> 8) & 0xFF;
+        for(i = done; i < done + n; i++) {
+            byte = (i % (width + 1)) ? pixels[(i / (width + 1)) * width + i % (width + 1) - 1] : 0;
+            z[pos++] = byte;
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        done += n;
+    }
+    put32(z + pos, (b << 16) | a);
+    pos += 4;
+
+    f = fopen(path, "wb");
+    if(!f) {
+        free(z);
+        return -1;
+    }
+    put32(ihdr, width);
+    put32(ihdr + 4, height);
+    ihdr[8] = 8;  // bit depth
+    ihdr[9] = 0;  // grayscale
+    ihdr[10] = 0; // deflate
+    ihdr[11] = 0; // adaptive filtering
+    ihdr[12] = 0; // no interlace
+    fwrite(signature, 1, 8, f);
+    chunk(f, "IHDR", ihdr, 13);
+    chunk(f, "IDAT", z, pos);
+    chunk(f, "IEND", NULL, 0);
+    fclose(f);
+    free(z);
+    return 0;
+}
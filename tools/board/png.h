@@ -0,0 +1,12 @@
+#ifndef __BOARD_PNG_H__
+#define __BOARD_PNG_H__
+
+#include <stdint.h>
+
+/*
+ * Minimal PNG writer for 8-bit grayscale images (stored deflate blocks, no
+ * zlib needed). Returns 0 on success, -1 if the file can't be written.
+ */
+int png_write_gray(const char *path, int width, int height, const uint8_t *pixels);
+
+#endif
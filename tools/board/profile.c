@@ -0,0 +1,63 @@
+#include <string.h>
+#include "sim_cycle_timers.h"
+#include "profile.h"
+
+#define SPL 0x5D // data space addresses of the stack pointer
+#define SPH 0x5E
+
+static uint16_t profile_flash(struct avr_t *avr, uint32_t addr) {
+    return avr->flash[addr] | (avr->flash[addr + 1] << 8);
+}
+
+// 1 when the instruction ending at byte address addr is a call
+static int profile_after_call(struct avr_t *avr, uint32_t addr) {
+    uint16_t op;
+
+    if(addr < 4 || addr > avr->flashend)
+        return 0;
+    op = profile_flash(avr, addr - 2);
+    if((op & 0xF000) == 0xD000 || op == 0x9509 || op == 0x9519) // RCALL, ICALL, EICALL
+        return 1;
+    op = profile_flash(avr, addr - 4);
+    return (op & 0xFE0E) == 0x940E; // CALL k (two words)
+}
+
+static avr_cycle_count_t profile_sample(struct avr_t *avr, avr_cycle_count_t when, void *param) {
+    profile_t *p = param;
+    uint16_t sp = avr->data[SPL] | (avr->data[SPH] << 8);
+    uint32_t a, ret;
+    int depth = 0;
+
+    fprintf(p->out, "%x", avr->pc);
+    // return addresses are pushed high byte at the lower address, as word addresses
+    for(a = sp + 1; a < avr->ramend && depth < PROFILE_DEPTH; ) {
+        ret = ((avr->data[a] << 8) | avr->data[a + 1]) * 2;
+        if(profile_after_call(avr, ret)) {
+            fprintf(p->out, " %x", ret);
+            depth++;
+            a += 2;
+        } else {
+            a++;
+        }
+    }
+    fputc('\n', p->out);
+    p->samples++;
+    return when + p->every;
+}
+
+int profile_init(struct avr_t *avr, profile_t *p, const char *path, avr_cycle_count_t every) {
+    memset(p, 0, sizeof(*p));
+    p->avr = avr;
+    p->every = every;
+    p->out = fopen(path, "w");
+    if(!p->out)
+        return -1;
+    avr_cycle_timer_register(avr, every, profile_sample, p);
+    return 0;
+}
+
+void profile_close(profile_t *p) {
+    if(p->out)
+        fclose(p->out);
+    p->out = NULL;
+}
@@ -0,0 +1,35 @@
+#ifndef __BOARD_PROFILE_H__
+#define __BOARD_PROFILE_H__
+
+#include <stdio.h>
+#include "sim_avr.h"
+
+/*
+ * Sampling PC profiler
+ *
+ * Every `every` cycles the program counter is sampled together with the
+ * return addresses found on the AVR stack, and written as one line of hex
+ * byte addresses, innermost first:
+ *
+ *     <pc> <return> <return> ...
+ *
+ * The stack is walked by scanning from SP up to RAMEND for words that point
+ * just after a CALL, RCALL or ICALL in flash. That needs no frame pointers
+ * or debug info, but it can pick up a stale return address left in a local,
+ * and an ISR's frame hides the function it interrupted (only that
+ * function's callers are seen). tools/profile.py symbolises the file.
+ */
+
+#define PROFILE_DEPTH 32
+
+typedef struct {
+    struct avr_t *avr;
+    FILE *out;
+    avr_cycle_count_t every;
+    unsigned long samples;
+} profile_t;
+
+int profile_init(struct avr_t *avr, profile_t *p, const char *path, avr_cycle_count_t every);
+void profile_close(profile_t *p);
+
+#endif
@@ -0,0 +1,40 @@
+#include <string.h>
+#include "avr_ioport.h"
+#include "sim_time.h"
+#include "servo.h"
+
+static void servo_pin(struct avr_irq_t *irq, uint32_t value, void *param) {
+    servo_t *s = param;
+    unsigned width;
+
+    if(value && !s->level) {
+        if(s->lastRise)
+            s->periodUs = avr_cycles_to_usec(s->avr, s->avr->cycle - s->lastRise);
+        s->rise = s->lastRise = s->avr->cycle;
+    } else if(!value && s->level) {
+        width = avr_cycles_to_usec(s->avr, s->avr->cycle - s->rise);
+        if(width < SERVO_VALID_MIN_US || width > SERVO_VALID_MAX_US) {
+            s->glitches++;
+        } else {
+            s->pulseUs = width;
+            s->pulses++;
+            if(width <= s->minUs)
+                s->angle = 0;
+            else if(width >= s->maxUs)
+                s->angle = 180;
+            else
+                s->angle = 180.0 * (width - s->minUs) / (s->maxUs - s->minUs);
+        }
+    }
+    s->level = value ? 1 : 0;
+}
+
+void servo_init(struct avr_t *avr, servo_t *s, char port, int pin, unsigned minUs, unsigned maxUs) {
+    memset(s, 0, sizeof(*s));
+    s->avr = avr;
+    s->pin = pin;
+    s->minUs = minUs;
+    s->maxUs = maxUs;
+    s->angle = 90; // unknown until the first pulse
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), pin), servo_pin, s);
+}
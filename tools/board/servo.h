@@ -0,0 +1,36 @@
+#ifndef __BOARD_SERVO_H__
+#define __BOARD_SERVO_H__
+
+#include <stdint.h>
+#include "sim_avr.h"
+#include "sim_cycle_timers.h"
+
+/*
+ * Hobby servo on one pin
+ *
+ * Each high pulse is timed; minUs .. maxUs maps linearly onto 0 .. 180
+ * degrees and the horn is taken to get there at once. Pulses outside
+ * SERVO_VALID_MIN_US .. SERVO_VALID_MAX_US are glitches and ignored, and
+ * with no pulses the servo stays where it was.
+ */
+
+#define SERVO_VALID_MIN_US 500
+#define SERVO_VALID_MAX_US 3500
+
+typedef struct {
+    struct avr_t *avr;
+    int pin;
+    uint8_t level;
+    avr_cycle_count_t rise;     // start of the current pulse
+    avr_cycle_count_t lastRise; // for the period
+    unsigned pulseUs;           // last valid pulse width
+    unsigned periodUs;          // rising edge to rising edge
+    unsigned minUs, maxUs;
+    double angle;
+    unsigned long pulses;
+    unsigned long glitches;
+} servo_t;
+
+void servo_init(struct avr_t *avr, servo_t *s, char port, int pin, unsigned minUs, unsigned maxUs);
+
+#endif
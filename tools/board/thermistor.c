@@ -0,0 +1,51 @@
+#include <math.h>
+#include <string.h>
+#include "avr_adc.h"
+#include "sim_time.h"
+#include "thermistor.h"
+
+static uint32_t thermistor_mv(thermistor_t *t) {
+    double kelvin = t->celsius + 273.15;
+    double r = t->r25 * exp(t->beta * (1.0 / kelvin - 1.0 / 298.15));
+    uint32_t avcc = t->avr->avcc ? t->avr->avcc : 5000;
+
+    return (uint32_t)(avcc * t->rFixed / (r + t->rFixed) + 0.5);
+}
+
+static void thermistor_update(thermistor_t *t) {
+    unsigned long ms = avr_cycles_to_usec(t->avr, t->avr->cycle) / 1000;
+    int i;
+
+    for(i = 0; i < t->steps && t->at[i] <= ms; i++)
+        t->celsius = t->to[i];
+    t->mv = thermistor_mv(t);
+    avr_raise_irq(t->input, t->mv);
+}
+
+static void thermistor_trigger(struct avr_irq_t *irq, uint32_t value, void *param) {
+    thermistor_t *t = param;
+    t->conversions++;
+    thermistor_update(t);
+}
+
+void thermistor_init(struct avr_t *avr, thermistor_t *t, int channel, double celsius) {
+    memset(t, 0, sizeof(*t));
+    t->avr = avr;
+    t->r25 = 10000;
+    t->beta = 3950;
+    t->rFixed = 10000;
+    t->celsius = celsius;
+    t->input = avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + channel);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_OUT_TRIGGER),
+            thermistor_trigger, t);
+    thermistor_update(t);
+}
+
+int thermistor_at(thermistor_t *t, unsigned long ms, double celsius) {
+    if(t->steps == THERMISTOR_STEPS)
+        return -1;
+    t->at[t->steps] = ms;
+    t->to[t->steps] = celsius;
+    t->steps++;
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef __BOARD_THERMISTOR_H__
+#define __BOARD_THERMISTOR_H__
+
+#include <stdint.h>
+#include "sim_avr.h"
+
+/*
+ * NTC thermistor divider on an ADC input
+ *
+ * The NTC (r25 at 25 C, beta) sits between AVCC and the pin with rFixed to
+ * ground, so the voltage rises with temperature. The temperature follows a
+ * schedule of (ms, celsius) steps; every conversion the firmware starts
+ * gets the voltage for the temperature at that moment.
+ */
+
+#define THERMISTOR_STEPS 32
+
+typedef struct {
+    struct avr_t *avr;
+    struct avr_irq_t *input;
+    double r25, beta, rFixed;
+    double celsius;
+    unsigned long at[THERMISTOR_STEPS]; // ms
+    double to[THERMISTOR_STEPS];        // celsius from at[i] on
+    int steps;
+    uint32_t mv;                        // last voltage applied
+    unsigned long conversions;
+} thermistor_t;
+
+void thermistor_init(struct avr_t *avr, thermistor_t *t, int channel, double celsius);
+
+/*
+ * Change to celsius at ms (steps in time order). Returns -1 when full.
+ */
+int thermistor_at(thermistor_t *t, unsigned long ms, double celsius);
+
+#endif
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""The RS-485 fan bus (header/bus.h) between simulated nodes, and its meter.
+
+Usage: tools/fanbus.py hub [-v] [--seconds N] PTY...
+       tools/fanbus.py bench --board BOARD [--seconds N] [--dir DIR] MASTER.elf NODE.elf...
+
+hub joins the nodes' USART0 ptys (build/board --pty) into one half-duplex
+line: whatever a node sends reaches every other node, but not the node
+itself (its receiver is off while it drives). It decodes the frames on the
+line and prints, per node, what the master's polling got out of it:
+
+    node  polls  answered  lost  polls/s  bytes/s  latency ms avg/max
+       1    812       812     0     40.6     1137        4.9/6.1
+
+Latency runs from the end of the master's frame to the end of the node's
+answer, as the hub saw them. A frame that starts before another node's
+frame has ended is a collision; the protocol should never make one.
+-v prints every frame. The line is polled, not clocked, so times are wall
+time and as good as the boards keep up with it (board --pty paces them).
+
+bench starts a virtual board per ELF (the master first), runs hub over
+them for --seconds after a short warm-up, and prints the table with how
+close to real time the slowest board ran. make busbench does this for a
+growing number of nodes.
+"""
+import argparse
+import os
+import select
+import signal
+import subprocess
+import sys
+import time
+
+from telemetry import BAUD, crc8, open_port
+
+SYNC1, SYNC2 = 0xA5, 0x5A
+MASTER, BROADCAST = 0x00, 0xFF
+BUS_POLL, BUS_CMD, BUS_STATUS = 0x30, 0x31, 0x32
+NAMES = {BUS_POLL: 'poll', BUS_CMD: 'cmd', BUS_STATUS: 'status'}
+STATUS_LEN = 11  # bus_status_t
+OVERHEAD = 5     # sync x2, len, type, crc
+WARMUP = 2.0     # seconds: boot, the first round of polls
+LINK_WAIT = 5.0  # seconds for the boards to make their ptys
+
+
+class Parser:
+    """Frames out of one port's bytes: (type, payload, first byte time, last byte time)."""
+
+    def __init__(self):
+        self.state, self.buf, self.start = 'sync1', [], 0.0
+        self.errors = 0
+
+    def feed(self, data, t):
+        for b in data:
+            if self.state == 'sync1':
+                if b == SYNC1:
+                    self.state, self.start = 'sync2', t
+            elif self.state == 'sync2':
+                self.state = 'body' if b == SYNC2 else 'sync2' if b == SYNC1 else 'sync1'
+                self.buf = []
+            else:
+                self.buf.append(b)
+                if len(self.buf) == self.buf[0] + 3:  # len, type, payload, crc
+                    self.state = 'sync1'
+                    body, crc = self.buf[:-1], self.buf[-1]
+                    if crc8(body) != crc:
+                        self.errors += 1
+                        continue
+                    yield body[1], bytes(body[2:]), self.start, t
+
+
+class Node:
+    def __init__(self):
+        self.polls = self.answered = self.bytes = 0
+        self.latency = []
+        self.pending = None  # (seq, end of the master's frame)
+
+
+class Meter:
+    def __init__(self, verbose):
+        self.verbose = verbose
+        self.reset(time.monotonic())
+
+    def reset(self, t):
+        self.nodes, self.t0 = {}, t
+        self.broadcasts = self.collisions = self.line = 0
+        self.last = None  # (port, end) of the latest frame
+
+    def frame(self, port, kind, payload, start, end):
+        size = len(payload) + OVERHEAD
+        self.line += size
+        if self.last and self.last[0] != port and start < self.last[1]:
+            self.collisions += 1
+        if not self.last or end >= self.last[1]:
+            self.last = (port, end)
+        if self.verbose:
+            print(f'{end - self.t0:9.4f} port {port} {NAMES.get(kind, hex(kind))} {payload.hex(" ")}')
+        if len(payload) < 3:
+            return
+        dst, src, seq = payload[:3]
+        if src == MASTER and kind in (BUS_POLL, BUS_CMD):
+            if dst == BROADCAST:
+                self.broadcasts += 1
+                return
+            n = self.nodes.setdefault(dst, Node())
+            n.polls += 1
+            n.bytes += size
+            n.pending = (seq, end)
+        elif kind == BUS_STATUS and dst == MASTER and len(payload) == STATUS_LEN:
+            n = self.nodes.setdefault(src, Node())
+            n.bytes += size
+            if n.pending and n.pending[0] == seq:
+                n.answered += 1
+                n.latency.append(end - n.pending[1])
+                n.pending = None
+
+    def report(self, t, out=sys.stdout):
+        secs = max(t - self.t0, 1e-9)
+        print(f'{len(self.nodes)} nodes, {secs:.1f} s, line {self.line * 10 / BAUD / secs:.0%} busy, '
+              f'{self.broadcasts} broadcasts, {self.collisions} collisions', file=out)
+        print('node  polls  answered  lost  polls/s  bytes/s  latency ms avg/max', file=out)
+        for i in sorted(self.nodes):
+            n = self.nodes[i]
+            lat = (f'{sum(n.latency) / len(n.latency) * 1000:.1f}/{max(n.latency) * 1000:.1f}'
+                   if n.latency else '-')
+            print(f'{i:4d} {n.polls:6d} {n.answered:9d} {n.polls - n.answered:5d} '
+                  f'{n.polls / secs:8.1f} {n.bytes / secs:8.0f}  {lat:>18s}', file=out)
+
+
+def hub(ports, seconds, verbose, warmup=0.0):
+    fds = [open_port(p) for p in ports]
+    parsers = [Parser() for _ in fds]
+    meter = Meter(verbose)
+    begin = time.monotonic()
+    measuring = warmup == 0
+    try:
+        while not seconds or time.monotonic() - begin < warmup + seconds:
+            ready, _, _ = select.select(fds, [], [], 0.1)
+            now = time.monotonic()
+            if not measuring and now - begin >= warmup:
+                meter.reset(now)
+                measuring = True
+            for fd in ready:
+                data = os.read(fd, 256)
+                for other in fds:
+                    if other != fd:
+                        os.write(other, data)  # one line: everyone else hears it
+                i = fds.index(fd)
+                for kind, payload, start, end in parsers[i].feed(data, now):
+                    meter.frame(i, kind, payload, start, end)
+    except KeyboardInterrupt:
+        pass
+    meter.report(time.monotonic())
+    errors = sum(p.errors for p in parsers)
+    if errors:
+        print(f'{errors} frames with a bad CRC')
+    return meter
+
+
+def board_ms(path):
+    """Simulated time a board's state file last showed."""
+    try:
+        with open(path) as f:
+            for line in f:
+                if line.startswith('time_ms='):
+                    return int(line.split('=', 1)[1])
+    except (OSError, ValueError):
+        pass
+    return 0
+
+
+def bench(board, elfs, seconds, workdir):
+    os.makedirs(workdir, exist_ok=True)
+    links = [os.path.join(workdir, f'bus{i}') for i in range(len(elfs))]
+    states = [os.path.join(workdir, f'board{i}.txt') for i in range(len(elfs))]
+    for path in links:
+        if os.path.lexists(path):
+            os.unlink(path)
+    procs = []
+    started = time.monotonic()  # simulated time starts about here too
+    try:
+        for elf, link, state in zip(elfs, links, states):
+            log = open(os.path.join(workdir, os.path.basename(link) + '.log'), 'w')
+            procs.append(subprocess.Popen([board, '--pty', link, '--state', state, elf],
+                                          stdout=log, stderr=subprocess.STDOUT))
+        while not all(os.path.exists(p) for p in links):
+            if time.monotonic() - started > LINK_WAIT or any(p.poll() is not None for p in procs):
+                sys.exit(f'fanbus: boards did not come up, see {workdir}/*.log')
+            time.sleep(0.05)
+        hub(links, seconds, False, warmup=WARMUP)
+    finally:
+        for p in procs:
+            p.send_signal(signal.SIGTERM)
+        for p in procs:
+            p.wait()  # each writes its final state
+    wall = time.monotonic() - started
+    slowest = min(board_ms(s) for s in states) / 1000
+    print(f'slowest board at {slowest / wall:.0%} of real time')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = ap.add_subparsers(dest='cmd', required=True)
+    h = sub.add_parser('hub')
+    h.add_argument('-v', action='store_true', help='print every frame')
+    h.add_argument('--seconds', type=float, default=0, help='stop after this long (default: ^C)')
+    h.add_argument('ports', nargs='+')
+    b = sub.add_parser('bench')
+    b.add_argument('--board', required=True, help='virtual board (make build/board)')
+    b.add_argument('--seconds', type=float, default=20)
+    b.add_argument('--dir', default='build/results/bus', help='ptys, board state and logs')
+    b.add_argument('elfs', nargs='+', help='master first, then the nodes')
+    args = ap.parse_args()
+    if args.cmd == 'hub':
+        hub(args.ports, args.seconds, args.v)
+    else:
+        bench(args.board, args.elfs, args.seconds, args.dir)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Send commands to the fan controller over USART0.
+
+Usage: tools/fanctl.py PORT OP[=ARG] ...
+
+OPs are sent as one batch (one CMD_FRAME) and run together; the ack and,
+for "query", the telemetry frame that follows it are printed. See
+header/command.h for the ops:
+
+    power=1 speed=2 duty=40 hold=1 servo=90 servo=release osc=0
+    tempmode=1 threshold=30 telemetry=10 query history=1 histrate=60 zone=2
+    temp=120
+
+zone=N makes the power, speed, tempmode, threshold and temp ops after it work
+zone N of a multi-zone unit (header/zone.h).
+
+(tools/history.py sends history=0, the dump, and decodes what comes back.)
+
+Example: tools/fanctl.py /dev/pts/3 power=1 speed=3 query
+The exit status is 0 when the batch was acked with CMD_OK.
+"""
+import os
+import sys
+
+from telemetry import TELEMETRY_FRAME, TELEMETRY, frame, frames, open_port, telemetry
+
+CMD_FRAME = 0x10
+CMD_ACK = 0x11
+
+OPS = {
+    'power': 0x01, 'speed': 0x02, 'duty': 0x03, 'hold': 0x04, 'servo': 0x05,
+    'osc': 0x06, 'tempmode': 0x07, 'threshold': 0x08, 'telemetry': 0x09,
+    'query': 0x0A, 'history': 0x0B, 'histrate': 0x0C, 'zone': 0x0D,
+    'temp': 0x0E,
+}
+STATUS = ['ok', 'bad op', 'bad arg', 'bad frame']
+TIMEOUT = 0.5  # seconds per try
+TRIES = 3
+
+
+def parse(words):
+    ops = []
+    for w in words:
+        op, _, arg = w.partition('=')
+        if op not in OPS:
+            sys.exit(f'fanctl: unknown op {op}')
+        ops += [OPS[op], 0xFF if arg == 'release' else int(arg or '0', 0)]
+    return ops
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    fd = open_port(sys.argv[1])
+    ops = parse(sys.argv[2:])
+    seq = os.getpid() & 0xFF
+    query = OPS['query'] in ops[0::2]
+    for _ in range(TRIES):
+        os.write(fd, frame(CMD_FRAME, [seq] + ops))
+        acked = False
+        for kind, payload in frames(fd, timeout=TIMEOUT):
+            if kind == CMD_ACK and len(payload) == 3 and payload[0] == seq:
+                status = payload[1]
+                print(f'ack seq={seq} {STATUS[status] if status < len(STATUS) else status}'
+                      f' ops={payload[2]}/{len(ops) // 2}', flush=True)
+                if status != 0 or not query:
+                    sys.exit(status != 0)
+                acked = True
+            elif acked and kind == TELEMETRY_FRAME and len(payload) == TELEMETRY.size:
+                print(telemetry(payload), flush=True)
+                sys.exit(0)
+        if acked:
+            sys.exit('fanctl: no telemetry after the ack')
+    sys.exit('fanctl: no ack')
+
+
+if __name__ == '__main__':
+    main()
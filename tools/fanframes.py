@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Generate the fan rotation frames shown on the animation display.
+
+Usage: tools/fanframes.py [--frames N] [--sweep DEG] header/fanbitmaps.h fan02 > header/fanframes.h
+
+The source bitmap is a 48x48 LCD Assistant array (6 banks of 48 columns,
+LSB at the top of each bank). It is rotated about its centre in N equal
+steps over SWEEP degrees (nearest neighbour) and written out as PROGMEM
+frames in the same layout. The fan has four blades, so a 90 degree sweep
+covers a full cycle of the animation.
+"""
+import argparse
+import math
+import re
+import sys
+
+WIDTH = 48
+HEIGHT = 48
+
+
+def load(path, name):
+    src = open(path).read()
+    m = re.search(r'\b' + re.escape(name) + r'\s*\[\s*\]\s*=\s*\{([^}]*)\}', src)
+    if not m:
+        sys.exit(f'fanframes: {name} not found in {path}')
+    data = [int(v, 16) for v in re.findall(r'0x[0-9a-fA-F]{2}', m.group(1))]
+    if len(data) != WIDTH * HEIGHT // 8:
+        sys.exit(f'fanframes: {name} has {len(data)} bytes, expected {WIDTH * HEIGHT // 8}')
+    return [[(data[(y // 8) * WIDTH + x] >> (y % 8)) & 1 for x in range(WIDTH)] for y in range(HEIGHT)]
+
+
+def rotate(pixels, degrees):
+    a = math.radians(degrees)
+    c, s = math.cos(a), math.sin(a)
+    cx, cy = (WIDTH - 1) / 2, (HEIGHT - 1) / 2
+    out = [[0] * WIDTH for _ in range(HEIGHT)]
+    for y in range(HEIGHT):
+        for x in range(WIDTH):
+            # inverse map: where does this output pixel come from
+            sx = c * (x - cx) + s * (y - cy) + cx
+            sy = -s * (x - cx) + c * (y - cy) + cy
+            ix, iy = int(round(sx)), int(round(sy))
+            if 0 <= ix < WIDTH and 0 <= iy < HEIGHT:
+                out[y][x] = pixels[iy][ix]
+    return out
+
+
+def pack(pixels):
+    data = []
+    for bank in range(HEIGHT // 8):
+        for x in range(WIDTH):
+            byte = 0
+            for bit in range(8):
+                byte |= pixels[bank * 8 + bit][x] << bit
+            data.append(byte)
+    return data
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument('--frames', type=int, default=8)
+    ap.add_argument('--sweep', type=float, default=90.0)
+    ap.add_argument('source')
+    ap.add_argument('name')
+    args = ap.parse_args()
+
+    pixels = load(args.source, args.name)
+    out = sys.stdout
+    out.write(f'// Fan rotation frames generated from {args.name} ({args.source.split("/")[-1]})\n')
+    out.write(f'// File generated by tools/fanframes.py --frames {args.frames} --sweep {args.sweep:g}, do not edit\n')
+    out.write('#ifndef __FANFRAMES_H__\n#define __FANFRAMES_H__\n\n')
+    out.write('#include <avr/pgmspace.h>\n\n')
+    out.write(f'#define FAN_FRAME_COUNT {args.frames}\n')
+    out.write(f'#define FAN_FRAME_WIDTH {WIDTH}\n')
+    out.write(f'#define FAN_FRAME_BANKS {HEIGHT // 8}\n\n')
+    out.write('const uint8_t fanFrames[FAN_FRAME_COUNT][FAN_FRAME_WIDTH * FAN_FRAME_BANKS] PROGMEM = {\n')
+    for i in range(args.frames):
+        angle = args.sweep * i / args.frames
+        data = pack(rotate(pixels, angle))
+        out.write(f'\t{{ // {angle:g} degrees\n')
+        for j in range(0, len(data), 16):
+            out.write('\t' + ', '.join(f'0x{b:02X}' for b in data[j:j + 16]) + ',\n')
+        out.write('\t},\n')
+    out.write('};\n\n#endif\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Pack the fixed 5x7 CHARSET into a proportional font for the Nokia driver.
+
+Usage: tools/fontpack.py header/nokia5110_chars.h > header/nokia5110_font_prop.h
+
+Empty columns on the left and right of every glyph are dropped and the
+remaining columns are stored back to back in PROP_GLYPHS. PROP_OFFSET[c] is
+the index of the first column of character 0x20 + c; the width of a glyph is
+PROP_OFFSET[c + 1] - PROP_OFFSET[c]. Blank glyphs (space) keep SPACE_WIDTH
+empty columns.
+"""
+import re
+import sys
+
+SPACE_WIDTH = 2
+ROW = re.compile(r'\{\s*((?:0x[0-9a-fA-F]{2}\s*,\s*){4}0x[0-9a-fA-F]{2})\s*\}\s*,?\s*//\s*(\w+)\s*(.*)')
+
+
+def parse(path):
+    glyphs = []
+    with open(path) as f:
+        for line in f:
+            m = ROW.search(line)
+            if m:
+                cols = [int(v, 16) for v in m.group(1).split(',')]
+                glyphs.append((cols, m.group(2), m.group(3).strip()))
+    return glyphs
+
+
+def trim(cols):
+    nonzero = [i for i, c in enumerate(cols) if c]
+    if not nonzero:
+        return [0x00] * SPACE_WIDTH
+    return cols[nonzero[0]:nonzero[-1] + 1]
+
+
+def main(path):
+    glyphs = parse(path)
+    packed, offsets = [], []
+    for cols, _, _ in glyphs:
+        offsets.append(len(packed))
+        packed.extend(trim(cols))
+    offsets.append(len(packed))
+
+    out = sys.stdout
+    out.write('// Proportional font packed from nokia5110_chars.h\n')
+    out.write('// File generated by tools/fontpack.py, do not edit\n')
+    out.write('#include <avr/pgmspace.h>\n\n')
+    out.write('#define PROP_FIRST 0x20\n')
+    out.write(f'#define PROP_COUNT {len(glyphs)}\n\n')
+    out.write('const uint8_t PROP_GLYPHS[] PROGMEM = {\n')
+    for (cols, code, name), start, end in zip(glyphs, offsets, offsets[1:]):
+        data = ', '.join(f'0x{c:02x}' for c in packed[start:end])
+        out.write(f'\t{data}, // {code} {name}\n')
+    out.write('};\n\n')
+    out.write('const uint16_t PROP_OFFSET[] PROGMEM = {\n')
+    for i in range(0, len(offsets), 12):
+        out.write('\t' + ', '.join(str(o) for o in offsets[i:i + 12]) + ',\n')
+    out.write('};\n')
+
+
+if __name__ == '__main__':
+    main(sys.argv[1] if len(sys.argv) > 1 else 'header/nokia5110_chars.h')
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Fetch and decode the controller's history log (header/history.h).
+
+Usage: tools/history.py [--save FILE] PORT
+       tools/history.py --load FILE
+
+Sends CMD_HISTORY 0 on PORT, collects the HISTORY_INFO and HISTORY_DATA
+frames of the dump and prints the log, one line per entry:
+
+    boot 1  00:42:10  x8  temp=131 duty=40% [fan,osc] overruns=2
+
+A line stands for x samples of the block's interval, from that time on.
+
+Times are since the start of that boot. The clock stops in standby, so a
+block marked "after standby" starts a new time base. --save writes the
+dump (the 6 byte HISTORY_INFO payload, then the log) for --load.
+"""
+import argparse
+import os
+import struct
+import sys
+
+from telemetry import FLAGS, frame, frames, open_port
+
+CMD_FRAME = 0x10
+CMD_ACK = 0x11
+CMD_HISTORY = 0x0B
+HISTORY_INFO = 0x12
+HISTORY_DATA = 0x13
+INFO = struct.Struct('<H3sB')  # used, now (3 bytes), period
+
+KEY = 0x80
+KEY_BOOT = 0x01
+KEY_WAKE = 0x02
+TEMP, DUTY, MODE, OVERRUNS = 0x01, 0x02, 0x04, 0x08
+TIMEOUT = 1.0  # seconds without a frame
+
+
+def fetch(port):
+    """(info payload, log bytes) of one complete dump."""
+    fd = open_port(port)
+    seq = os.getpid() & 0xFF
+    os.write(fd, frame(CMD_FRAME, [seq, CMD_HISTORY, 0]))
+    info, data = None, {}
+    for kind, payload in frames(fd, timeout=TIMEOUT):
+        if kind == CMD_ACK and len(payload) == 3 and payload[0] == seq and payload[1]:
+            sys.exit(f'history: command failed, status {payload[1]}')
+        elif kind == HISTORY_INFO and len(payload) == INFO.size:
+            info, data = payload, {}  # (re)started
+        elif kind == HISTORY_DATA and info and len(payload) > 2:
+            data[payload[0] | payload[1] << 8] = payload[2:]
+            used = INFO.unpack(info)[0]
+            log = b''.join(data[k] for k in sorted(data))
+            if len(log) >= used:
+                return info, log[:used]
+        if info and INFO.unpack(info)[0] == 0:
+            return info, b''
+    sys.exit('history: no complete dump')
+
+
+def varint(log, i):
+    v = shift = 0
+    while True:
+        b = log[i]
+        i += 1
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80 or shift >= 28:
+            return v, i
+
+
+def unzigzag(z):
+    return (z >> 1) ^ -(z & 1)
+
+
+def entries(log):
+    """Yield (keyframe or None, values, samples) per entry.
+
+    keyframe is (flags, interval, stamp); values is [temp, duty, flags, overruns].
+    """
+    i = 0
+    v = [0, 0, 0, 0]
+    while i < len(log):
+        tag = log[i]
+        i += 1
+        rep = (tag >> 4) & 7
+        if tag & KEY:
+            interval, i = varint(log, i)
+            stamp = log[i] | log[i + 1] << 8 | log[i + 2] << 16
+            v = list(log[i + 3:i + 7])
+            i += 7
+            yield (tag & 0x0F, interval, stamp), list(v), rep + 1
+            continue
+        if tag & TEMP:
+            d, i = varint(log, i)
+            v[0] = (v[0] + unzigzag(d)) & 0xFF
+        if tag & DUTY:
+            d, i = varint(log, i)
+            v[1] = (v[1] + unzigzag(d)) & 0xFF
+        if tag & MODE:
+            v[2] = log[i]
+            i += 1
+        v[3] = 0
+        if tag & OVERRUNS:
+            v[3], i = varint(log, i)
+        yield None, list(v), rep + 1
+
+
+def clock(s):
+    return f'{s // 3600:02d}:{s // 60 % 60:02d}:{s % 60:02d}'
+
+
+def show(info, log):
+    used, now, period = INFO.unpack(info)
+    now = int.from_bytes(now, 'little')
+    print(f'{used} bytes, up {clock(now)}, sampling every {period}s' if period
+          else f'{used} bytes, up {clock(now)}, sampling stopped')
+    boot = 0 if log and log[0] & KEY and log[0] & KEY_BOOT else 1
+    t = interval = 0
+    samples = 0
+    for key, v, n in entries(log):
+        if key:
+            flags, interval, t = key
+            if flags & KEY_BOOT:
+                boot += 1
+            notes = [w for f, w in ((KEY_BOOT, 'reset'), (KEY_WAKE, 'after standby')) if flags & f]
+            print(f'-- every {interval}s' + (f' ({", ".join(notes)})' if notes else ''))
+        on = ','.join(f for b, f in enumerate(FLAGS) if v[2] & (1 << b)) or '-'
+        print(f'boot {boot}  {clock(t)}  x{n:<2d} temp={v[0]} duty={v[1]}% [{on}] overruns={v[3]}')
+        t += n * interval
+        samples += n
+    print(f'{samples} samples')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('--save', help='write the dump here')
+    ap.add_argument('--load', help='decode a saved dump instead')
+    ap.add_argument('port', nargs='?')
+    args = ap.parse_args()
+    if args.load:
+        raw = open(args.load, 'rb').read()
+        info, log = raw[:INFO.size], raw[INFO.size:]
+    elif args.port:
+        info, log = fetch(args.port)
+    else:
+        sys.exit(__doc__)
+    if args.save:
+        with open(args.save, 'wb') as out:
+            out.write(info + log)
+    show(info, log)
+
+
+if __name__ == '__main__':
+    main()
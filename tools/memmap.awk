@@ -0,0 +1,57 @@
+# Per-symbol SRAM map for "make memmap"
+# Input: avr-size -A main.elf, then avr-nm -S --size-sort -t d main.elf
+# Variables (set from the Makefile): ram, data, bss, stack
+#   ram   - total SRAM of the part
+#   data  - budget for .data (initialised globals, copied from flash)
+#   bss   - budget for .bss and .noinit (zeroed and uninitialised globals)
+#   stack - minimum headroom that must be left for the stack
+# Totals are the section sizes from avr-size; the symbols only break them
+# down. What no symbol covers -- string literals, which avr-gcc keeps in
+# .data with the rest of .rodata -- shows up as "(unnamed)".
+# Exits non-zero when any budget is exceeded.
+
+# avr-gcc's data address space: SRAM at 0x800000, EEPROM from 0x810000.
+# Leaves out the simavr .mmcu section, which isn't loaded.
+function inRam(addr) {
+    return addr >= 8388608 && addr < 8454144
+}
+
+NF == 3 && $1 ~ /^\.(data|bss|noinit)$/ {
+    if ($1 == ".data")
+        dataTotal += $2
+    else
+        bssTotal += $2
+    next
+}
+
+$3 ~ /^[dDbB]$/ && NF == 4 && inRam($1 + 0) {
+    size = $2 + 0
+    if ($3 ~ /[dD]/) {
+        dataSyms[++nData] = sprintf("%6d  %s", size, $4)
+        dataNamed += size
+    } else {
+        bssSyms[++nBss] = sprintf("%6d  %s", size, $4)
+        bssNamed += size
+    }
+}
+
+function section(title, syms, n, named, total, budget,    i) {
+    printf("%s (budget %d bytes)\n", title, budget)
+    if (total > named)
+        printf("  %6d  (unnamed)\n", total - named)
+    for (i = n; i >= 1; i--)
+        print "  " syms[i]
+    printf("  ------\n  %6d  total%s\n\n", total, total > budget ? "  ** OVER BUDGET **" : "")
+}
+
+END {
+    section(".data", dataSyms, nData, dataNamed, dataTotal, data)
+    section(".bss", bssSyms, nBss, bssNamed, bssTotal, bss)
+    free = ram - dataTotal - bssTotal
+    printf("SRAM %d bytes: .data %d + .bss %d, %d left for stack (reserve %d)\n",
+        ram, dataTotal, bssTotal, free, stack)
+    if (dataTotal > data || bssTotal > bss || free < stack) {
+        print "memmap: SRAM budget exceeded"
+        exit 1
+    }
+}
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Compare instruction counts of driver objects with and without pins.h.
+
+Usage: tools/pincount.py [--objdump OBJDUMP] GENERIC.o PINS.o [GENERIC.o PINS.o ...]
+
+Each pair is one driver compiled twice, with -DPINS_GENERIC (plain C port
+expressions) and without (sbi/cbi/in/out through pins.h), see "make
+pincheck". Prints the instructions per function in both builds and exits
+with status 1 when any function got longer with pins.h.
+"""
+import argparse
+import re
+import subprocess
+import sys
+
+FUNCTION = re.compile(r'^[0-9a-f]+ <([^>]+)>:$')
+INSN = re.compile(r'^\s+[0-9a-f]+:\t[0-9a-f]{2} [0-9a-f]{2} ')
+
+
+def counts(objdump, obj):
+    """{function: instructions} for the code in obj."""
+    out = subprocess.run([objdump, '-d', obj], check=True,
+                         capture_output=True, text=True).stdout
+    found = {}
+    function = None
+    for line in out.splitlines():
+        m = FUNCTION.match(line)
+        if m:
+            function = m.group(1)
+            found[function] = 0
+        elif function and INSN.match(line):
+            found[function] += 1
+    return found
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('--objdump', default='avr-objdump')
+    ap.add_argument('objects', nargs='+')
+    args = ap.parse_args()
+    if len(args.objects) % 2:
+        sys.exit('pincount: objects come in GENERIC.o PINS.o pairs')
+
+    grew = []
+    total_before = total_after = 0
+    print(f'{"generic":>8} {"pins":>8} {"change":>7}  function')
+    for generic, pins in zip(args.objects[::2], args.objects[1::2]):
+        before = counts(args.objdump, generic)
+        after = counts(args.objdump, pins)
+        for f in sorted(set(before) | set(after)):
+            b, a = before.get(f, 0), after.get(f, 0)
+            total_before += b
+            total_after += a
+            if a > b:
+                grew.append(f)
+            print(f'{b:8d} {a:8d} {a - b:+7d}  {f}')
+    print(f'{total_before:8d} {total_after:8d} {total_after - total_before:+7d}  total')
+
+    if grew:
+        sys.exit('pincount: longer with pins.h: ' + ', '.join(grew))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Symbolise PC samples from the virtual board (make profile).
+
+Usage: tools/profile.py [--nm NM] [--addr2line A2L] [--folded FILE]
+                        [--lines N] firmware.elf SAMPLES
+
+SAMPLES is what board --profile writes (tools/board/profile.h): one sample
+per line, hex byte addresses, the PC first and then the return addresses
+found on the stack, innermost first. Prints a flat profile -- per function
+the samples with the PC in it (self) and the samples with it anywhere on
+the stack (total) -- and the source lines with the most self samples.
+With --folded, also writes the samples as folded stacks,
+
+    main;nokia_bus_Tick;nokia_write 123
+
+which flamegraph.pl, inferno or speedscope turn into a flame graph.
+"""
+import argparse
+import bisect
+import collections
+import subprocess
+import sys
+
+TEXT_TYPES = 'tTwW'
+DATA_BASE = 0x800000  # avr-gcc puts SRAM symbols here
+
+
+def symbols(nm, elf):
+    """Sorted (address, name) of the code symbols in elf."""
+    out = subprocess.run([nm, '-n', '--defined-only', elf], check=True,
+                         capture_output=True, text=True).stdout
+    syms = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) != 3 or parts[1] not in TEXT_TYPES:
+            continue
+        addr = int(parts[0], 16)
+        if addr < DATA_BASE:
+            syms.append((addr, parts[2]))
+    if not syms:
+        sys.exit(f'profile: no code symbols in {elf}')
+    return syms
+
+
+def lines(addr2line, elf, addrs):
+    """{address: 'file:line'} for addrs, through one addr2line per chunk."""
+    addrs = sorted(addrs)
+    found = {}
+    for i in range(0, len(addrs), 512):
+        chunk = addrs[i:i + 512]
+        out = subprocess.run([addr2line, '-e', elf] + [f'{a:x}' for a in chunk],
+                             check=True, capture_output=True, text=True).stdout
+        for a, where in zip(chunk, out.splitlines()):
+            found[a] = where.split(' ')[0]
+    return found
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('--nm', default='avr-nm')
+    ap.add_argument('--addr2line', default='avr-addr2line')
+    ap.add_argument('--folded', help='write folded stacks here')
+    ap.add_argument('--lines', type=int, default=20, help='source lines to list')
+    ap.add_argument('elf')
+    ap.add_argument('samples')
+    args = ap.parse_args()
+
+    syms = symbols(args.nm, args.elf)
+    starts = [a for a, _ in syms]
+
+    def function(addr):
+        i = bisect.bisect_right(starts, addr) - 1
+        return syms[i][1] if i >= 0 else f'0x{addr:x}'
+
+    stacks = collections.Counter()
+    for line in open(args.samples):
+        addrs = tuple(int(a, 16) for a in line.split())
+        if addrs:
+            stacks[addrs] += 1
+    total = sum(stacks.values())
+    if not total:
+        sys.exit(f'profile: no samples in {args.samples}')
+
+    selfs = collections.Counter()
+    totals = collections.Counter()
+    pcs = collections.Counter()
+    folded = collections.Counter()
+    for addrs, n in stacks.items():
+        pc, returns = addrs[0], addrs[1:]
+        # a return address can be the first byte of the next function when
+        # the call was the last instruction, so name the call itself
+        frames = [function(pc)] + [function(r - 2) for r in returns]
+        selfs[frames[0]] += n
+        for f in set(frames):
+            totals[f] += n
+        pcs[pc] += n
+        folded[';'.join(reversed(frames))] += n
+
+    print(f'{total} samples')
+    print()
+    print(f'{"self":>8} {"%":>6} {"total":>8} {"%":>6}  function')
+    for f, n in sorted(totals.items(), key=lambda kv: (-selfs[kv[0]], -kv[1], kv[0])):
+        print(f'{selfs[f]:8d} {100.0 * selfs[f] / total:6.2f} {n:8d} {100.0 * n / total:6.2f}  {f}')
+
+    where = lines(args.addr2line, args.elf, pcs)
+    by_line = collections.Counter()
+    for pc, n in pcs.items():
+        by_line[(where.get(pc, '??:0'), function(pc))] += n
+    print()
+    print(f'{"self":>8} {"%":>6}  line')
+    for (loc, f), n in by_line.most_common(args.lines):
+        print(f'{n:8d} {100.0 * n / total:6.2f}  {loc} ({f})')
+
+    if args.folded:
+        with open(args.folded, 'w') as out:
+            for stack, n in sorted(folded.items()):
+                out.write(f'{stack} {n}\n')
+
+
+if __name__ == '__main__':
+    main()
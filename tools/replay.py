@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Input traces for the replay build (make replay, header/replay.h).
+
+Usage:
+  tools/replay.py header [--max-gap MS] TRACE > replaytrace.h
+  tools/replay.py vcd FILE.vcd > TRACE
+  tools/replay.py log < simavr-output > LOG
+
+A trace is text, one input per line, times in ms from the start of the run:
+
+    # comment
+    120 pina 0x07      PINA button bits (PA0-3, active low)
+    250 pina 0x0F
+    900 ir 0xFFA25D    NEC code as in keyValue[] (IR.h)
+    1000 adc 96        temperature sample, zone temp units
+
+header  compiles a trace into the PROGMEM table replay.c plays back. Gaps
+        between inputs longer than --max-gap are shortened to it: once every
+        firmware timeout (standby, settings write, stall) has run out nothing
+        changes until the next input, so hours of idle time cost seconds.
+vcd     pulls a trace out of a simavr VCD with a full PINA trace (see
+        simAVRHeader.h): button changes become pina lines and the IR
+        receiver's edges on PA4 are decoded back into ir lines.
+log     keeps the replay log lines ("rp ...") from simavr's UART output,
+        ready to diff against a golden log. Fails when the end line is
+        missing or reports UART bytes dropped on the way.
+"""
+import argparse
+import re
+import sys
+
+KINDS = {'pina': 'REPLAY_PINA', 'ir': 'REPLAY_IR', 'adc': 'REPLAY_ADC'}
+WAIT = 'REPLAY_WAIT'
+BUTTONS = 0x0F
+IR = 0x10
+
+
+def read_trace(path):
+    records = []
+    last = 0
+    for n, line in enumerate(open(path), 1):
+        line = line.split('#', 1)[0].split()
+        if not line:
+            continue
+        if len(line) != 3 or line[1] not in KINDS:
+            sys.exit(f'replay: {path}:{n}: expected "<ms> pina|ir|adc <value>"')
+        t, kind, value = int(line[0]), line[1], int(line[2], 0)
+        if t < last:
+            sys.exit(f'replay: {path}:{n}: time goes backwards')
+        records.append((t, kind, value))
+        last = t
+    return records
+
+
+def header(args):
+    out = []
+    last = 0
+    skipped = 0
+    for t, kind, value in read_trace(args.trace):
+        gap = t - last
+        if gap > args.max_gap:
+            skipped += gap - args.max_gap
+            gap = args.max_gap
+        while gap > 0xFFFF:
+            out.append((0xFFFF, WAIT, 0))
+            gap -= 0xFFFF
+        out.append((gap, KINDS[kind], value))
+        last = t
+    if not out:
+        out.append((0, WAIT, 0))
+    print(f'/* Generated by tools/replay.py from {args.trace}, do not edit. */')
+    print(f'/* {len(out)} records, {skipped} ms of idle time skipped (--max-gap {args.max_gap}) */')
+    print()
+    print(f'#define REPLAY_RECORDS {len(out)}')
+    print()
+    print('const replay_record_t replayTrace[REPLAY_RECORDS] PROGMEM = {')
+    for dt, kind, value in out:
+        print(f'    {{{dt}, {kind}, 0x{value:X}UL}},')
+    print('};')
+
+
+def read_vcd(path, name):
+    """Yield (time in ms, value) for every change of the signal called name."""
+    scale = 1e-9
+    ident = None
+    units = {'s': 1, 'ms': 1e-3, 'us': 1e-6, 'ns': 1e-9, 'ps': 1e-12}
+    text = open(path).read()
+    m = re.search(r'\$timescale\s+(\d+)\s*(\w+)\s+\$end', text)
+    if m:
+        scale = int(m.group(1)) * units[m.group(2)]
+    for m in re.finditer(r'\$var\s+\S+\s+\d+\s+(\S+)\s+(\S+)', text):
+        if m.group(2) == name:
+            ident = m.group(1)
+    if ident is None:
+        sys.exit(f'replay: no {name} signal in {path}')
+    body = text[text.index('$enddefinitions'):]
+    t = 0
+    for tok in re.finditer(r'#(\d+)|b([01xz]+)\s+(\S+)|([01xz])(\S+)', body):
+        if tok.group(1):
+            t = int(tok.group(1)) * scale * 1000
+        elif (tok.group(3) or tok.group(5)) == ident:
+            bits = tok.group(2) or tok.group(4)
+            yield t, int(bits.replace('x', '1').replace('z', '1'), 2)
+
+
+def nec_decode(edges):
+    """NEC codes from the falling edges of the receiver (ms), as input.c."""
+    codes = []
+    bits = None
+    code = 0
+    for prev, t in zip(edges, edges[1:]):
+        dt = t - prev
+        if 12.5 <= dt <= 14.5:
+            bits, code, start = 0, 0, prev
+        elif bits is None or bits >= 32:
+            continue
+        elif 0.9 <= dt <= 1.4 or 2.0 <= dt <= 2.5:
+            code = (code << 1) | (dt >= 2.0)
+            bits += 1
+            if bits == 32:
+                codes.append((start, code))
+        else:
+            bits = None
+    return codes
+
+
+def vcd(args):
+    lines = []
+    falling = []
+    level = None
+    for t, value in read_vcd(args.vcd, args.signal):
+        if level is None or (value ^ level) & BUTTONS:
+            lines.append((t, 'pina', f'0x{value & BUTTONS:02X}'))
+        if level is not None and level & IR and not value & IR:
+            falling.append(t)
+        level = value
+    lines += [(t, 'ir', f'0x{code:X}') for t, code in nec_decode(falling)]
+    print(f'# from {args.vcd}')
+    for t, kind, value in sorted(lines):
+        print(f'{round(t)} {kind} {value}')
+
+
+def log(args):
+    dropped = None
+    for line in sys.stdin:
+        # simavr prints UART lines in colour, with control characters as '.'
+        line = re.sub(r'\x1b\[[0-9;]*m', '', line).strip().rstrip('.')
+        m = re.search(r'\brp \d+ .*', line)
+        if m:
+            print(m.group(0))
+            end = re.fullmatch(r'rp \d+ end dropped=(\d+)', m.group(0))
+            if end:
+                dropped = int(end.group(1))
+    if dropped is None:
+        sys.exit('replay: no end line, the log is incomplete')
+    if dropped:
+        sys.exit(f'replay: the firmware dropped {dropped} UART bytes, the log is incomplete')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = ap.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('header')
+    p.add_argument('--max-gap', type=int, default=10000)
+    p.add_argument('trace')
+    p.set_defaults(run=header)
+    p = sub.add_parser('vcd')
+    p.add_argument('--signal', default='PINA')
+    p.add_argument('vcd')
+    p.set_defaults(run=vcd)
+    p = sub.add_parser('log')
+    p.set_defaults(run=log)
+    args = ap.parse_args()
+    args.run(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Decode the telemetry stream sent on USART0.
+
+Usage: tools/telemetry.py [--raw] PORT|FILE
+
+PORT is a serial device or a simavr pty (opened raw at 38400 baud); FILE is a
+capture of the line. Frames are 0xA5 0x5A len type payload crc8, with the
+CRC-8/CCITT (poly 0x07, init 0) covering len, type and payload -- see
+header/uart.h. Telemetry frames (type 0x01) follow telemetry_t in
+header/telemetry.h and are printed one per line; other frame types are shown
+as hex. Bytes outside frames (printf text under simavr) are skipped, or
+echoed with --raw.
+"""
+import argparse
+import os
+import select
+import struct
+import sys
+
+SYNC = b'\xa5\x5a'
+BAUD = 38400
+
+TELEMETRY_FRAME = 0x01
+TELEMETRY = struct.Struct('<H4BBBBBBBHHBBBHBB')  # telemetry_t
+FLAGS = ['fan', 'osc', 'temp', 'hold', 'stall', 'motor']
+
+M_STATES = ['start', 'off', 'on']
+OSC_STATES = ['start', 'off', 'wait', 'left', 'right', 'hold']
+D2_STATES = ['start', 'output', 'pause']
+H_STATES = ['start', 'open', 'hold']
+
+
+def frame(kind, payload):
+    """Encode one frame for the controller."""
+    body = bytes([len(payload), kind]) + bytes(payload)
+    return SYNC + body + bytes([crc8(body)])
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def open_port(path):
+    flags = os.O_RDONLY if os.path.isfile(path) else os.O_RDWR | os.O_NOCTTY
+    fd = os.open(path, flags)
+    if os.isatty(fd):
+        import termios
+        import tty
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        attrs[4] = attrs[5] = termios.B38400
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def frames(fd, raw=None, timeout=None):
+    """Yield (type, payload) for every frame with a good CRC.
+
+    With a timeout (seconds), stop once nothing has arrived for that long.
+    """
+    buf = bytearray()
+    while True:
+        if timeout is not None and not select.select([fd], [], [], timeout)[0]:
+            return
+        chunk = os.read(fd, 256)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                # keep a trailing 0xA5, it may start the next sync
+                keep = 1 if buf[-1:] == SYNC[:1] else 0
+                if raw:
+                    raw(bytes(buf[:len(buf) - keep]))
+                del buf[:len(buf) - keep]
+                break
+            if raw and i:
+                raw(bytes(buf[:i]))
+            del buf[:i]
+            if len(buf) < 4 or len(buf) < 5 + buf[2]:
+                break
+            n = buf[2]
+            body = bytes(buf[2:4 + n])
+            if crc8(body) != buf[4 + n]:
+                del buf[:1]  # false sync, look again one byte on
+                continue
+            del buf[:5 + n]
+            yield body[1], body[2:]
+
+
+def name(table, i):
+    return table[i] if i < len(table) else str(i)
+
+
+def telemetry(payload):
+    (ms, m, osc, d2, h, flags, speed, duty, servo, temp, threshold,
+     rpm, loop_max, overruns, evq, uart, stack, fg_max, fg_skipped) = TELEMETRY.unpack(payload)
+    on = ','.join(f for i, f in enumerate(FLAGS) if flags & (1 << i)) or '-'
+    fg_str = '>1ms' if fg_max == 0xFF else f'{fg_max * 8}us'
+    return (f'{ms:5d}ms M={name(M_STATES, m)} osc={name(OSC_STATES, osc)} '
+            f'd2={name(D2_STATES, d2)} H={name(H_STATES, h)} [{on}] '
+            f'speed={speed} duty={duty}% servo={servo}ms temp={temp}/{threshold} '
+            f'rpm={rpm} loop={loop_max * 8}us fg={fg_str} skip={fg_skipped} overrun={overruns} '
+            f'drop={evq}/{uart} stack={stack}')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('--raw', action='store_true', help='echo bytes outside frames')
+    ap.add_argument('port')
+    args = ap.parse_args()
+
+    fd = open_port(args.port)
+    raw = (lambda b: sys.stdout.write(b.decode('ascii', 'replace'))) if args.raw else None
+    try:
+        for kind, payload in frames(fd, raw):
+            if kind == TELEMETRY_FRAME and len(payload) == TELEMETRY.size:
+                print(telemetry(payload), flush=True)
+            else:
+                print(f'frame {kind:#04x}: {payload.hex(" ")}', flush=True)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()